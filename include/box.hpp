@@ -17,24 +17,27 @@ class Box
 
         double getEstDistanceSquared(const Coordinates &point) const;
 
-        const Coordinates getTopLeft() const { return Coordinates(mMinLatitude, mMinLongitude); }
-        const Coordinates getTopRight() const { return Coordinates(mMinLatitude, mMaxLongitude); }
-        const Coordinates getBottomLeft() const { return Coordinates(mMaxLatitude, mMinLongitude); }
-        const Coordinates getBottomRight() const { return Coordinates(mMaxLatitude, mMaxLongitude); }
+        const Coordinates getTopLeft() const { return Coordinates::fromFixedPoint(mMinLatitude, mMinLongitude); }
+        const Coordinates getTopRight() const { return Coordinates::fromFixedPoint(mMinLatitude, mMaxLongitude); }
+        const Coordinates getBottomLeft() const { return Coordinates::fromFixedPoint(mMaxLatitude, mMinLongitude); }
+        const Coordinates getBottomRight() const { return Coordinates::fromFixedPoint(mMaxLatitude, mMaxLongitude); }
 
-        const Coordinates getCenter() const { return Coordinates((mMinLatitude + mMaxLatitude) / 2.0, (mMinLongitude + mMaxLongitude) / 2.0); }
-        const Coordinates getTopMiddle() const { return Coordinates(mMinLatitude, (mMinLongitude + mMaxLongitude) / 2.0); }
-        const Coordinates getBottomMiddle() const { return Coordinates(mMaxLatitude, (mMinLongitude + mMaxLongitude) / 2.0); }
-        const Coordinates getLeftMiddle() const { return Coordinates((mMinLatitude + mMaxLatitude) / 2.0, mMinLongitude); }
-        const Coordinates getRightMiddle() const { return Coordinates((mMinLatitude + mMaxLatitude) / 2.0, mMaxLongitude); }
+        const Coordinates getCenter() const { return Coordinates::fromFixedPoint(middle(mMinLatitude, mMaxLatitude), middle(mMinLongitude, mMaxLongitude)); }
+        const Coordinates getTopMiddle() const { return Coordinates::fromFixedPoint(mMinLatitude, middle(mMinLongitude, mMaxLongitude)); }
+        const Coordinates getBottomMiddle() const { return Coordinates::fromFixedPoint(mMaxLatitude, middle(mMinLongitude, mMaxLongitude)); }
+        const Coordinates getLeftMiddle() const { return Coordinates::fromFixedPoint(middle(mMinLatitude, mMaxLatitude), mMinLongitude); }
+        const Coordinates getRightMiddle() const { return Coordinates::fromFixedPoint(middle(mMinLatitude, mMaxLatitude), mMaxLongitude); }
 
-        const Coordinates getMinLatitudeLongitude() const { return Coordinates(mMinLatitude, mMinLongitude); }
-        const Coordinates getMaxLatitudeLongitude() const { return Coordinates(mMaxLatitude, mMaxLongitude); }
+        const Coordinates getMinLatitudeLongitude() const { return Coordinates::fromFixedPoint(mMinLatitude, mMinLongitude); }
+        const Coordinates getMaxLatitudeLongitude() const { return Coordinates::fromFixedPoint(mMaxLatitude, mMaxLongitude); }
 
     private:
-        double mMinLatitude;
-        double mMinLongitude;
+        // Fixed point like Coordinates, so containment tests compare integers
+        int32_t mMinLatitude;
+        int32_t mMinLongitude;
 
-        double mMaxLatitude;
-        double mMaxLongitude;
+        int32_t mMaxLatitude;
+        int32_t mMaxLongitude;
+
+        static int32_t middle(int32_t min, int32_t max) { return static_cast<int32_t>((static_cast<int64_t>(min) + max) / 2); }
 };
\ No newline at end of file
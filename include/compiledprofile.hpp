@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Edge;
+class Graph;
+class Weights;
+struct Tag;
+
+// Cost of every edge under one Weights instance, compiled once into a flat array indexed by the Graph's dense edge index.
+// Edges are grouped by their interned tag set, so a changed (key, value) weight only recomputes the sets containing
+// that tag and their edges. Without Weights the costs are the plain edge lengths. Split items added to the Graph later
+// are costed on access, so the array never grows while queries read it.
+class CompiledProfile
+{
+    public:
+        // weights may be nullptr for the unweighted profile; it must outlive the profile
+        CompiledProfile(const Graph &graph, const Weights *weights);
+
+        float getCost(uint32_t edgeIndex) const { return edgeIndex < mEdgeCount ? mCosts[edgeIndex] : getSplitItemCost(edgeIndex); }
+        // Costs of the edges present at construction
+        std::span<const float> getCosts() const { return mCosts; }
+
+        bool isWeighted() const { return mWeights != nullptr; }
+        const Weights *getWeights() const { return mWeights; }
+
+        // Recompiles the edges carrying a tag whose weight changed; the Router calls it from Weights::setWeight.
+        // Like all cost changes not thread-safe against running queries. Returns whether any cost changed.
+        bool updateTag(const Tag &tag);
+
+        // Edge::setWeight changes a length the profile has cached; recompiles that edge
+        void updateEdge(const Edge &edge);
+
+    private:
+        const Graph &mGraph;
+        const Weights *mWeights;
+
+        std::vector<float> mCosts;
+        // Edges present at construction; split items follow
+        uint32_t mEdgeCount;
+
+        // Tag sets of the compiled edges, numbered locally in order of first appearance
+        std::vector<uint32_t> mEdgeTagSets;
+        std::vector<uint32_t> mTagSetIds;                    // local -> TagDictionary tag set ID
+        std::vector<double> mTagSetWeights;
+        std::vector<uint32_t> mTagSetEdgeOffsets;            // edges of local set s: mTagSetEdges[offsets[s], offsets[s + 1])
+        std::vector<uint32_t> mTagSetEdges;
+        ankerl::unordered_dense::map<uint64_t, std::vector<uint32_t>> mTagSetsByTag;   // Weights::getTagKey -> local sets
+
+        float computeCost(const Edge &edge, double weight) const;
+        float getSplitItemCost(uint32_t edgeIndex) const;
+};
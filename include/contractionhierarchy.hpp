@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "csrgraph.hpp"
+#include "searchcontext.hpp"
+
+class Graph;
+class Weights;
+
+// Contraction Hierarchy over the CSR graph for one cost profile (edge weight, optionally scaled by Weights).
+// Costs are taken when the hierarchy is built; later changes to edge weights or Weights are not reflected.
+class ContractionHierarchy
+{
+    public:
+        static constexpr uint32_t INVALID_INDEX = SearchContext::INVALID_INDEX;
+
+        // Upward arc, stored with the lower ranked node as source. Shortcuts keep the two arcs they replace,
+        // so every shortcut can be unpacked into the underlying edge sequence.
+        struct Arc
+        {
+            uint32_t source;
+            uint32_t target;
+            double cost;
+            uint32_t edge;                                   // graph edge index; INVALID_INDEX for shortcuts
+            uint32_t reversed;                               // original arcs: source is edge->to()
+            uint32_t sourceChild;                            // shortcuts: arc middle -> source
+            uint32_t targetChild;                            // shortcuts: arc middle -> target
+        };
+
+        // One traversed edge of an unpacked path
+        struct Step
+        {
+            uint32_t from;
+            uint32_t to;
+            uint32_t edge;
+            bool reversed;
+        };
+
+        ContractionHierarchy(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights);
+
+        // Loads the hierarchy from filename if it matches the graph and profile, otherwise builds and saves it
+        static std::unique_ptr<ContractionHierarchy> loadOrBuild(const std::string &filename, const Graph &graph, const CsrGraph &csrGraph, const Weights *weights);
+
+        bool save(const std::string &filename) const;
+
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(mRanks.size()); }
+        uint32_t getRank(uint32_t node) const { return mRanks[node]; }
+        size_t getArcCount() const { return mArcs.size(); }
+        size_t getShortcutCount() const;
+        bool isWeighted() const { return mWeighted; }
+
+        // Shortest path between two nodes; start and goal may be phantom nodes of the context's overlay.
+        // On success the unpacked path is written into the context's labels, as a unidirectional search leaves it.
+        bool query(SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const;
+
+    private:
+        friend class CustomizableContractionHierarchy;
+
+        ContractionHierarchy() = default;
+
+        std::vector<uint32_t> mRanks;
+        std::vector<uint32_t> mOffsets;
+        std::vector<Arc> mArcs;
+
+        std::vector<double> mEdgeCosts;
+        uint64_t mCostHash = 0;
+        bool mWeighted = false;
+
+        static std::vector<double> computeEdgeCosts(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights);
+        static uint64_t hashCosts(const CsrGraph &csrGraph, const std::vector<double> &edgeCosts);
+
+        void contract(const CsrGraph &csrGraph);
+        // False if the file is missing, stale or inconsistent; the caller then rebuilds the hierarchy
+        bool load(const std::string &filename, const CsrGraph &csrGraph);
+        bool isValid(uint32_t edgeCount) const;
+
+        void unpack(uint32_t arc, bool fromSource, std::vector<Step> &steps) const;
+};
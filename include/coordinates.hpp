@@ -1,21 +1,43 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <ostream>
+#include <string>
 
+// Latitude and longitude as int32 fixed point with 7 decimal places, the precision OSM stores them in.
+// Half the size of two doubles; the getters convert back and return exactly the parsed double for every OSM coordinate.
 class Coordinates
 {
     public:
+        static constexpr double FIXED_POINT_SCALE = 1e7;
+
         Coordinates(double latitude, double longitude)
-            : mLatitude(latitude), mLongitude(longitude) {}
+            : mLatitude(toFixedPoint(latitude)), mLongitude(toFixedPoint(longitude)) {}
+
+        explicit Coordinates(const std::string &coordString);
 
-        explicit Coordinates(const std::string &coordString);   
+        static Coordinates fromFixedPoint(int32_t latitude, int32_t longitude)
+        {
+            Coordinates coordinates(0.0, 0.0);
+            coordinates.mLatitude = latitude;
+            coordinates.mLongitude = longitude;
+            return coordinates;
+        }
 
-        double getLatitude() const { return mLatitude; }
-        double getLongitude() const { return mLongitude; }
+        double getLatitude() const { return mLatitude / FIXED_POINT_SCALE; }
+        double getLongitude() const { return mLongitude / FIXED_POINT_SCALE; }
+
+        int32_t getFixedLatitude() const { return mLatitude; }
+        int32_t getFixedLongitude() const { return mLongitude; }
 
         friend std::ostream& operator<<(std::ostream& os, const Coordinates& coords);
 
     private:
-        double mLatitude;
-        double mLongitude;
-};
\ No newline at end of file
+        int32_t mLatitude;
+        int32_t mLongitude;
+
+        // Out of range values (e.g. the bounds of an empty graph) are clamped so the conversion cannot overflow
+        static int32_t toFixedPoint(double degrees) { return static_cast<int32_t>(std::lround(std::clamp(degrees, -180.0, 180.0) * FIXED_POINT_SCALE)); }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "coordinates.hpp"
+
+class Graph;
+
+// Immutable compressed-sparse-row adjacency built once from a Graph.
+// Uses the Graph's dense node and edge indices; arcs of a node are stored contiguously.
+class CsrGraph
+{
+    public:
+        struct Arc
+        {
+            uint32_t target;
+            uint32_t edge : 31;
+            uint32_t reversed : 1;                           // arc runs edge->to() -> edge->from()
+        };
+
+        // Arcs of nodes and edges that are not part of the CSR arrays: split items added to the Graph after construction
+        // and per-query phantom nodes. Split items use the Graph indices following getNodeCount() / getEdgeCount(),
+        // phantom nodes the indices following the Graph's node count.
+        struct Overlay
+        {
+            struct OverlayArc
+            {
+                uint32_t source;
+                Arc arc;
+                double weightFactor;                         // share of the edge weight covered by the arc
+            };
+
+            // Virtual node on an edge; lets a query start or end mid-edge without modifying the Graph
+            struct PhantomNode
+            {
+                Coordinates coordinates;
+                uint32_t edge;
+                uint8_t segmentIndex;
+                double fraction;                             // position along the edge, 0 = from(), 1 = to()
+            };
+
+            uint32_t phantomBase = 0;
+            std::vector<OverlayArc> arcs;                    // sorted by source, see addArc
+            std::vector<PhantomNode> phantomNodes;
+
+            bool empty() const { return arcs.empty(); }
+            void clear() { arcs.clear(); phantomNodes.clear(); }
+
+            // Keeps arcs sorted by source so that getArcs stays logarithmic with many phantom nodes (distance matrices)
+            void addArc(uint32_t source, const Arc &arc, double weightFactor)
+            {
+                auto position = std::upper_bound(arcs.begin(), arcs.end(), source, [](uint32_t node, const OverlayArc &overlayArc) { return node < overlayArc.source; });
+                arcs.insert(position, {source, arc, weightFactor});
+            }
+
+            std::span<const OverlayArc> getArcs(uint32_t node) const
+            {
+                auto [first, last] = std::equal_range(arcs.begin(), arcs.end(), OverlayArc{node, {}, 0.0}, [](const OverlayArc &a, const OverlayArc &b) { return a.source < b.source; });
+                return {first, last};
+            }
+
+            uint32_t getNodeCount() const { return phantomBase + static_cast<uint32_t>(phantomNodes.size()); }
+            bool isPhantom(uint32_t node) const { return node >= phantomBase && node - phantomBase < phantomNodes.size(); }
+            const PhantomNode &getPhantomNode(uint32_t node) const { return phantomNodes[node - phantomBase]; }
+        };
+
+        explicit CsrGraph(const Graph &graph);
+
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(mCoordinates.size()); }
+        uint32_t getEdgeCount() const { return mEdgeCount; }
+
+        std::span<const Arc> getArcs(uint32_t node) const { return {mArcs.data() + mOffsets[node], mArcs.data() + mOffsets[node + 1]}; }
+
+        const Coordinates &getCoordinates(uint32_t node) const { return mCoordinates[node]; }
+
+        // Collects the Graph's split items into an overlay on top of the CSR arrays
+        void buildOverlay(const Graph &graph, Overlay &overlay) const;
+
+        // Adds a phantom node at point (projected onto the given segment of the edge) and its arcs to the overlay.
+        // Returns the node index of the phantom node.
+        uint32_t addPhantomNode(const Graph &graph, Overlay &overlay, const Coordinates &point, uint32_t edgeIndex, uint8_t segmentIndex) const;
+
+    private:
+        std::vector<uint32_t> mOffsets;
+        std::vector<Arc> mArcs;
+
+        std::vector<Coordinates> mCoordinates;
+        uint32_t mEdgeCount = 0;
+};
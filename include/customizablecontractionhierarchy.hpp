@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "contractionhierarchy.hpp"
+#include "csrgraph.hpp"
+
+class Graph;
+class Weights;
+
+// Customizable Contraction Hierarchy: the node order and the shortcut topology depend only on the graph and are built once.
+// customize() derives the arc costs for the current edge weights and Weights and yields a queryable ContractionHierarchy.
+class CustomizableContractionHierarchy
+{
+    public:
+        explicit CustomizableContractionHierarchy(const CsrGraph &csrGraph);
+
+        // Computes all arc costs for the current metric; threadCount 0 uses all hardware threads.
+        // The returned hierarchy is a snapshot and is not affected by later customizations.
+        std::unique_ptr<ContractionHierarchy> customize(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights, unsigned threadCount = 0) const;
+
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(mRanks.size()); }
+        size_t getArcCount() const { return mTargets.size(); }
+        size_t getTriangleCount() const { return mTriangles.size(); }
+
+    private:
+        // Lower triangle of an arc u -> w: a lower ranked node x with arcs x -> u and x -> w
+        struct Triangle
+        {
+            uint32_t sourceArc;                              // x -> u
+            uint32_t targetArc;                              // x -> w
+        };
+
+        // Original edge between the endpoints of an arc
+        struct EdgeRef
+        {
+            uint32_t edge;
+            uint32_t reversed;                               // arc source is edge->to()
+        };
+
+        std::vector<uint32_t> mRanks;
+
+        // Upward arcs grouped by source, sorted by target within a node
+        std::vector<uint32_t> mSources;
+        std::vector<uint32_t> mOffsets;
+        std::vector<uint32_t> mTargets;
+
+        std::vector<uint32_t> mEdgeOffsets;
+        std::vector<EdgeRef> mEdges;
+
+        std::vector<uint32_t> mTriangleOffsets;
+        std::vector<Triangle> mTriangles;
+
+        // Nodes grouped by elimination tree level; the arcs of a level only depend on lower levels
+        std::vector<uint32_t> mLevelOffsets;
+        std::vector<uint32_t> mLevelNodes;
+
+        void computeOrder(const CsrGraph &csrGraph);
+        void buildTopology(const CsrGraph &csrGraph);
+
+        uint32_t findArc(uint32_t source, uint32_t target) const;
+};
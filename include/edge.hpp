@@ -7,29 +7,39 @@
 #include <functional>
 #include <coordinates.hpp>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include "parameters.hpp"
 
 class Edge
 {
     public:
-        Edge(uint64_t id, double waylength, std::shared_ptr<Node> from, std::shared_ptr<Node> to, std::vector<Coordinates> path);
+        // The polyline is the range [pathOffset, pathOffset + pathSize) of the Graph's geometry pool
+        Edge(uint64_t id, double waylength, std::shared_ptr<Node> from, std::shared_ptr<Node> to, const std::vector<Coordinates> &geometry, uint32_t pathOffset, uint32_t pathSize);
 
         double getWeight() const { return mWaylength; }
+        // Routers cache edge costs; call Router::updateEdgeCost after changing the length of a routed graph
         void setWeight(double waylength) { mWaylength = waylength; }
         void setParameters(const Parameters &parameters) { mParameters = parameters; }
         Parameters &getParameters() { return mParameters; }
+        const Parameters &getParameters() const { return mParameters; }
 
         double calculateWayLength() const;
 
         const uint64_t getId() const { return mId; }
 
+        // Dense index (0..M-1) assigned by the Graph on insertion
+        uint32_t getIndex() const { return mIndex; }
+        void setIndex(uint32_t index) { mIndex = index; }
+
         std::shared_ptr<Node> from() const { return mNodes[0].lock(); }
         std::shared_ptr<Node> to() const { return mNodes[1].lock(); }
 
-        const std::vector<Coordinates> &getPath() const { return mPath; }
+        // Valid until the Graph adds further geometry, e.g. split items
+        std::span<const Coordinates> getPath() const { return std::span<const Coordinates>(mGeometry->data() + mPathOffset, mPathSize); }
 
-        const Box getBoundingBox(uint8_t subWayId) const { return Box(mPath[subWayId], mPath[subWayId + 1]); }
+        const Box getBoundingBox(uint8_t subWayId) const { return Box(getPath()[subWayId], getPath()[subWayId + 1]); }
 
         uint16_t snapPointCounter = 0;
         uint16_t bestSnapPointCounter = 0;
@@ -39,8 +49,11 @@ class Edge
 
     private:
         uint64_t mId;
+        uint32_t mIndex = Node::INVALID_INDEX;
         double mWaylength;
         std::array<std::weak_ptr<Node>, 2> mNodes;
         Parameters mParameters;
-        std::vector<Coordinates> mPath;
+        const std::vector<Coordinates> *mGeometry;
+        uint32_t mPathOffset;
+        uint32_t mPathSize;
 };
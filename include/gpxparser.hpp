@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <chrono>
 #include <format>
+#include <span>
 #include <unordered_set>
 
 #include "coordinates.hpp"
@@ -13,6 +14,8 @@
 
 #define MIN_ROUTING_LENGTH 50
 #define MAX_ROUTING_LENGTH 250
+// Edges within this distance (m) of a track point are weighted as candidates
+#define SNAP_RADIUS 20
 
 // Track: Filename and vector of coordinates
 typedef std::unordered_map<std::string, std::vector<Coordinates>> Tracks;
@@ -38,9 +41,9 @@ class GPXParser
         std::unordered_set<Edge *> mEdges;
 
         void parseGPXFile(const std::filesystem::directory_entry &file);
-        bool checkRoutingTrackPoints(const std::vector<ClosestEdges> &edges, std::vector<Coordinates> &routingTrackPoints, uint16_t pointIndex, const Coordinates &coordinates);
+        bool checkRoutingTrackPoints(std::span<const ClosestEdges> edges, std::vector<Coordinates> &routingTrackPoints, uint16_t pointIndex, const Coordinates &coordinates);
         void resetRoutingPoints();
-        void reset();
+        void reset(Router &router);
         
 
         Coordinates bestPointCoords{0, 0};
@@ -3,6 +3,7 @@
 #include <vector>
 #include <ankerl/unordered_dense.h>
 #include <memory>
+#include <span>
 #include <tuple>
 
 #include <osmnode.hpp>
@@ -13,9 +14,22 @@
 class Graph
 {
     public:
+        Graph() = default;
+        // Edges point into the geometry pool of their Graph
+        Graph(const Graph &) = delete;
+        Graph &operator=(const Graph &) = delete;
+
         void addOsmNode(std::shared_ptr<OsmNode> node);
         void addOsmWay(const OsmWay *way);
 
+        // Adds a routing node or an edge between two nodes given by dense index, e.g. from a GraphSnapshot
+        Node *addNode(uint64_t nodeId, const Coordinates &coordinates);
+        // The path is copied into the geometry pool
+        Edge *addEdge(uint64_t edgeId, double waylength, uint32_t fromIndex, uint32_t toIndex, std::span<const Coordinates> path, const Parameters &parameters);
+        // Avoids regrowing the pool when the total number of polyline points is known in advance
+        void reserveGeometry(size_t pointCount) { mGeometry.reserve(pointCount); }
+        size_t getGeometrySize() const { return mGeometry.size(); }
+
         uint64_t addSplit(Coordinates closestCoords, uint64_t edgeId, uint8_t segmentIndex);
 
         void removeSplitItems();
@@ -28,11 +42,30 @@ class Graph
 
         const Edge *getEdge(uint64_t edgeId) const { return mEdges.at(edgeId).get(); }
 
+        // Dense index access; split items get the indices following the regular nodes and edges
+        Node *getNodeByIndex(uint32_t index) const { return mNodesByIndex[index]; }
+        Edge *getEdgeByIndex(uint32_t index) const { return mEdgesByIndex[index]; }
+
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(mNodesByIndex.size()); }
+        uint32_t getEdgeCount() const { return static_cast<uint32_t>(mEdgesByIndex.size()); }
+
+        // Translates an OSM node ID into its dense index; only meant for the API boundary
+        uint32_t getNodeIndex(uint64_t nodeId) const { return mNodes.at(nodeId)->getIndex(); }
+
         const std::vector<uint64_t> &getSplitItemIds() const { return mSplitItemIds; }
     private:
         ankerl::unordered_dense::map<uint64_t, std::shared_ptr<Node>> mNodes;
         ankerl::unordered_dense::map<uint64_t, std::shared_ptr<Edge>> mEdges;
 
+        std::vector<Node *> mNodesByIndex;
+        std::vector<Edge *> mEdgesByIndex;
+
+        // Polylines of all edges back to back, one allocation instead of one per edge; split items are appended at the end
+        std::vector<Coordinates> mGeometry;
+        size_t mSplitGeometryOffset = 0;
+
         std::vector<uint64_t> mSplitItemIds;
         uint8_t mSplitItemCount = 0;
+
+        uint32_t addGeometry(std::span<const Coordinates> path);
 };
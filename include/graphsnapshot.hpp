@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "box.hpp"
+#include "mappedfile.hpp"
+
+class Graph;
+class PackedRTree;
+
+// Versioned, checksummed binary image of a Graph and its PackedRTree, written by router_snapshot.
+// The file is memory-mapped read-only; every section is a flat, 8-byte aligned array of the records below,
+// so loading only validates the header, checksum and record indices and walks the arrays once to create the Graph.
+class GraphSnapshot
+{
+    public:
+        // Coordinates are stored in the fixed point representation of Coordinates
+        struct NodeRecord
+        {
+            uint64_t id;
+            int32_t latitude;
+            int32_t longitude;
+        };
+
+        struct EdgeRecord
+        {
+            uint64_t id;
+            double weight;
+            uint32_t from;                                   // dense node indices
+            uint32_t to;
+            uint32_t geometryOffset;                         // range in getGeometry()
+            uint32_t geometryCount;
+            uint32_t tagOffset;                              // range in getTags()
+            uint32_t tagCount;
+        };
+
+        struct PointRecord
+        {
+            int32_t latitude;
+            int32_t longitude;
+        };
+
+        // Interned tag; key and value index the string table
+        struct TagRecord
+        {
+            uint32_t key;
+            uint32_t value;
+        };
+
+        // Fixed point bounding box: the area of the source file, and the boxes of the R-tree
+        struct BoxRecord
+        {
+            int32_t minLatitude;
+            int32_t minLongitude;
+            int32_t maxLatitude;
+            int32_t maxLongitude;
+        };
+
+        // Segment in a leaf of the R-tree
+        struct SegmentRecord
+        {
+            uint32_t edge;                                   // dense edge index
+            uint32_t subwayId;
+        };
+
+        // Maps the file and validates magic, version, size, checksum and every index stored in the records;
+        // throws std::runtime_error if any of them does not match
+        explicit GraphSnapshot(const std::string &filename);
+
+        // True if the file starts with the snapshot magic; lets router_app accept snapshots and .osm files alike
+        static bool isSnapshot(const std::string &filename);
+
+        // Writes graph and R-tree; the graph must not contain split items. boundary is the area of the source file
+        static void write(const std::string &filename, const Graph &graph, const PackedRTree &rtree, const Box &boundary);
+
+        std::span<const NodeRecord> getNodes() const { return getSection<NodeRecord>(NODES); }
+        std::span<const EdgeRecord> getEdges() const { return getSection<EdgeRecord>(EDGES); }
+        std::span<const PointRecord> getGeometry() const { return getSection<PointRecord>(GEOMETRY); }
+        std::span<const TagRecord> getTags() const { return getSection<TagRecord>(TAGS); }
+        // The flat arrays of PackedRTree; see there for their layout
+        std::span<const BoxRecord> getRTreeBoxes() const { return getSection<BoxRecord>(RTREE_BOXES); }
+        std::span<const uint32_t> getRTreeLevelOffsets() const { return getSection<uint32_t>(RTREE_LEVEL_OFFSETS); }
+        std::span<const SegmentRecord> getRTreeSegments() const { return getSection<SegmentRecord>(RTREE_SEGMENTS); }
+        std::span<const uint32_t> getRTreeFirstChildren() const { return getSection<uint32_t>(RTREE_FIRST_CHILDREN); }
+
+        std::string_view getString(uint32_t index) const;
+
+        // Area of the source file the graph was read from
+        Box getBoundary() const;
+
+        // Adds all nodes and edges to an empty graph, keeping the dense indices of the written graph
+        void createGraph(Graph &graph) const;
+
+    private:
+        enum Section : uint32_t
+        {
+            NODES,
+            EDGES,
+            GEOMETRY,
+            TAGS,
+            STRING_OFFSETS,
+            STRINGS,
+            BOUNDARY,
+            RTREE_BOXES,
+            RTREE_LEVEL_OFFSETS,
+            RTREE_SEGMENTS,
+            RTREE_FIRST_CHILDREN,
+            SECTION_COUNT
+        };
+
+        struct SectionEntry
+        {
+            uint64_t offset;                                 // bytes from the start of the file
+            uint64_t count;                                  // records
+        };
+
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t fileSize;
+            uint64_t checksum;                               // over everything after the header
+            SectionEntry sections[SECTION_COUNT];
+        };
+
+        MappedFile mFile;
+
+        const FileHeader &getHeader() const { return *reinterpret_cast<const FileHeader *>(mFile.data()); }
+
+        template <typename Record>
+        std::span<const Record> getSection(Section section) const
+        {
+            const SectionEntry &entry = getHeader().sections[section];
+            return {reinterpret_cast<const Record *>(mFile.data() + entry.offset), static_cast<size_t>(entry.count)};
+        }
+
+        static uint64_t checksum(const char *data, size_t size);
+};
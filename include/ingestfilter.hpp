@@ -0,0 +1,53 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "box.hpp"
+#include "coordinates.hpp"
+
+// Declarative filter applied while an OSM file is streamed, replacing a separate osmfilter run.
+// A way is kept if it satisfies every tag rule; of its tags only the kept keys end up in the edge parameters,
+// missing ones as "unknown". Nodes outside the bounding box or polygon are dropped and their ways are cut there.
+class IngestFilter
+{
+    public:
+        // Routable ways: requires a highway tag and keeps only the highway key, without spatial restriction
+        IngestFilter();
+
+        // Requires the key with one of the values; any value if values is empty
+        void requireTag(const std::string &key, std::vector<std::string> values = {});
+        // Drops ways having the key with one of the values; any value if values is empty
+        void excludeTag(const std::string &key, std::vector<std::string> values = {});
+        void clearTagRules() { mRules.clear(); }
+
+        void setKeptKeys(std::vector<std::string> keys) { mKeptKeys = std::move(keys); }
+        const std::vector<std::string> &getKeptKeys() const { return mKeptKeys; }
+
+        void setBoundingBox(const Box &boundingBox) { mBoundingBox = boundingBox; }
+        // Closed ring of at least three points in latitude/longitude; the closing point may be omitted
+        void setPolygon(std::vector<Coordinates> polygon);
+
+        // Keys the readers have to decode: the kept keys and those of the tag rules
+        std::vector<std::string> getDecodedKeys() const;
+
+        bool matches(const std::vector<std::pair<std::string, std::string>> &tags) const;
+        bool hasArea() const { return mBoundingBox.has_value() || !mPolygon.empty(); }
+        bool contains(const Coordinates &point) const;
+
+    private:
+        struct TagRule
+        {
+            std::string key;
+            std::vector<std::string> values;
+            bool exclude;
+        };
+
+        std::vector<TagRule> mRules;
+        std::vector<std::string> mKeptKeys;
+        std::optional<Box> mBoundingBox;
+        std::vector<Coordinates> mPolygon;
+        std::optional<Box> mPolygonBounds;
+};
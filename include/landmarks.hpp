@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "csrgraph.hpp"
+
+class Graph;
+class Weights;
+
+enum class LandmarkSelection
+{
+    Farthest,                                                // each landmark maximizes the distance to the ones chosen before
+    Avoid                                                    // Goldberg/Harrelson: grow a shortest path tree and avoid regions that are already covered well
+};
+
+// Landmark distance tables for ALT (A*, landmarks, triangle inequality) over the CSR graph for one cost profile.
+// Distance is float (meters of cost) or uint32_t (centimeters of cost); tables are node-major, one row of
+// getLandmarkCount() entries per node. Costs are taken when the tables are built, like for ContractionHierarchy.
+template <typename Distance>
+class Landmarks
+{
+    public:
+        static constexpr Distance UNREACHABLE = std::numeric_limits<Distance>::has_infinity ? std::numeric_limits<Distance>::infinity() : std::numeric_limits<Distance>::max();
+
+        Landmarks(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights, uint32_t landmarkCount, LandmarkSelection selection = LandmarkSelection::Avoid);
+
+        uint32_t getLandmarkCount() const { return static_cast<uint32_t>(mLandmarks.size()); }
+        uint32_t getLandmark(uint32_t landmark) const { return mLandmarks[landmark]; }
+        bool isWeighted() const { return mWeighted; }
+
+        // The graph is undirected, so one table serves as forward (landmark -> node) and backward (node -> landmark) distances
+        double getDistance(uint32_t node, uint32_t landmark) const { return toCost(mDistances[static_cast<size_t>(node) * mLandmarks.size() + landmark]); }
+
+        // Landmark distances of node written to distances, infinity if unreachable
+        void getDistances(uint32_t node, double *distances) const;
+
+        // Lower bound on the cost between node and a node with the given landmark distances
+        double getLowerBound(uint32_t node, const double *distances) const;
+
+        // Lower bound between two nodes given both distance vectors
+        double getLowerBound(const double *from, const double *to) const;
+
+        size_t getMemoryUsage() const { return mDistances.size() * sizeof(Distance); }
+
+    private:
+        // Best triangle inequality bound over all landmarks
+        struct Bound
+        {
+            double lowerBound = 0;
+            double largest = 0;                              // larger distance of the best landmark, scales the float rounding slack
+
+            void add(double from, double to);
+            double get() const;
+        };
+
+        std::vector<uint32_t> mLandmarks;
+        std::vector<Distance> mDistances;
+        bool mWeighted;
+
+        static Distance fromCost(double cost);
+        static double toCost(Distance distance);
+};
+
+extern template class Landmarks<float>;
+extern template class Landmarks<uint32_t>;
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -13,6 +14,7 @@
 #include "coordinates.hpp"
 #include "box.hpp"
 #include "edge.hpp"
+#include "ingestfilter.hpp"
 
 class Graph;
 class OsmNode;
@@ -30,7 +32,7 @@ namespace HelperFunctions
 
     double euclideanDistanceSquared(const Coordinates &c1, const Coordinates &c2);
 
-    double calculatePathLength(const std::vector<Coordinates> &path);
+    double calculatePathLength(std::span<const Coordinates> path);
 
     double distancePointToSegment(const Coordinates &point, const Coordinates &segStart, const Coordinates &segEnd);
 
@@ -38,14 +40,26 @@ namespace HelperFunctions
 
     std::filesystem::path exportPathToGeoJSON(const std::vector<std::tuple<uint64_t, Coordinates>> &path, const std::filesystem::path &filename);
 
+    // Reads .osm XML files; files ending in .pbf are passed on to readPBFFile
     void readOSMFile(const std::string &filepath,
                      ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes,
                      ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways);
 
+    // Reads .osm.pbf files without conversion, decoding blocks on threadCount threads (0 = all hardware threads)
+    void readPBFFile(const std::string &filepath,
+                     ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes,
+                     ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways,
+                     unsigned threadCount = 0);
+
     const Box createGraph(Graph &graph,
                      ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes,
                      ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways);
 
+    // Builds the graph in two passes with flat arrays instead of per-node objects: the first pass collects the
+    // ways accepted by the filter and the nodes they reference, the second reads only the coordinates of those nodes.
+    // With the default filter the same graph as readOSMFile followed by createGraph, with a peak memory close to the size of the result.
+    const Box readOSMGraph(const std::string &filepath, Graph &graph, const IngestFilter &filter = IngestFilter(), unsigned threadCount = 0);
+
     double logisticFunction(double x, double lowerBound = 0, double upperBound = 1, double steepness = 1, double maxGrowthX = 0);
 
     std::vector<std::vector<Coordinates>> getGPXTrackPoints(const std::filesystem::path &file);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only memory mapping of a whole file; falls back to reading the file into memory where mmap is not available
+class MappedFile
+{
+    public:
+        // Throws std::runtime_error if the file cannot be opened or mapped
+        explicit MappedFile(const std::string &filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data() const { return mData; }
+        size_t size() const { return mSize; }
+        std::string_view view() const { return {mData, mSize}; }
+
+    private:
+        const char *mData = nullptr;
+        size_t mSize = 0;
+        std::vector<char> mBuffer;
+};
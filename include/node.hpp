@@ -3,6 +3,7 @@
 #include "osmnode.hpp"
 #include "coordinates.hpp"
 
+#include <cstdint>
 #include <vector>
 #include <limits>
 #include <memory>
@@ -14,6 +15,12 @@ class Node : public OsmNode
     public:
         Node(const OsmNode &other) : OsmNode(other) {}
 
+        static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+        // Dense index (0..N-1) assigned by the Graph on insertion
+        uint32_t getIndex() const { return mIndex; }
+        void setIndex(uint32_t index) { mIndex = index; }
+
         friend std::ostream& operator<<(std::ostream& os, const Node& node)
         {
             return os << "NODE: " << node.getId() << ", " << node.getCoordinates() << ", Edges: " << node.edges.size();
@@ -21,13 +28,6 @@ class Node : public OsmNode
 
         std::vector<std::shared_ptr<Edge>> edges;
 
-        double g = std::numeric_limits<double>::infinity();  // known cost from start
-        double f = std::numeric_limits<double>::infinity();  // estimated total cost
-        uint64_t parent = 0;                                 // predecessor node id
-        bool visited = false;
-        Edge *parentEdge = nullptr;                          // edge used to reach this node
-        bool parentEdgeReversed = false;                     // traversal direction flag
-        uint32_t searchEpoch = 0;
-
     private:
+        uint32_t mIndex = INVALID_INDEX;
 };
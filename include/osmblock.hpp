@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Nodes and ways decoded from one part of an OSM file, in file order; produced by PbfReader and OsmXmlScanner
+struct OsmBlock
+{
+    // Element types a reader decodes; the others are skipped without parsing
+    enum Content : uint8_t
+    {
+        NODES = 1,
+        WAYS = 2,
+        ALL = NODES | WAYS
+    };
+
+    struct Node
+    {
+        uint64_t id;
+        double latitude;
+        double longitude;
+    };
+
+    struct Way
+    {
+        uint64_t id;
+        std::vector<uint64_t> nodeRefs;
+        std::vector<std::pair<std::string, std::string>> tags;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Way> ways;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mappedfile.hpp"
+#include "osmblock.hpp"
+
+// Scanner specialized on the flat structure of OSM XML files (node, way, relation elements with nd and tag children).
+// The file is memory-mapped and split at element boundaries into chunks that are scanned in parallel; markup is
+// located with memchr and numbers are parsed in place with std::from_chars, without a general XML parser.
+class OsmXmlScanner
+{
+    public:
+        // Only way tags whose key is in wayKeys are kept; node tags and relations are skipped.
+        // Throws std::runtime_error if the file cannot be opened.
+        OsmXmlScanner(const std::string &filepath, std::vector<std::string> wayKeys, OsmBlock::Content content = OsmBlock::ALL);
+
+        // Calls consumer with every chunk in file order; threadCount 0 uses all hardware threads
+        void read(const std::function<void(OsmBlock &&)> &consumer, unsigned threadCount = 0) const;
+
+        // Chunk boundaries; every chunk starts at a node, way or relation element
+        std::vector<size_t> getChunkOffsets(size_t chunkSize) const;
+
+        // Scans the bytes [begin, end) of the file
+        OsmBlock scanChunk(size_t begin, size_t end) const;
+
+    private:
+        MappedFile mFile;
+        std::vector<std::string> mWayKeys;
+        OsmBlock::Content mContent;
+
+        bool isWayKey(std::string_view key) const;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "box.hpp"
+#include "edge.hpp"
+#include "graph.hpp"
+#include "quadtree.hpp"
+
+class GraphSnapshot;
+
+// Result of PackedRTree::getClosestEdgesBatch: resultCount entries per query point, in the order of the points
+struct ClosestEdgesBatch
+{
+    uint32_t pointCount = 0;
+    uint8_t resultCount = 0;
+    std::vector<ClosestEdges> results;                       // closest first; missing results have distance max and no edge
+
+    std::span<const ClosestEdges> getClosestEdges(uint32_t point) const { return {results.data() + static_cast<size_t>(point) * resultCount, resultCount}; }
+};
+
+// Static R-tree over all edge segments of a Graph, bulk-loaded with Sort-Tile-Recursive packing.
+// Every node has up to NODE_SIZE children and all segments sit in the leaves, so unlike in the Quadtree long roads
+// and segments crossing a midline do not pile up near the root. The levels are stored back to back in flat arrays,
+// with the bounding boxes split into one array per coordinate.
+// The segments of a leaf are additionally kept as float arrays relative to the leaf, so a SIMD kernel measures all of
+// them at once in a planar approximation; the haversine distance is only computed for segments that can still make the results.
+class PackedRTree
+{
+    public:
+        // Indexes the edges present in the graph; split items added later are not part of the tree
+        explicit PackedRTree(const Graph &graph);
+
+        // Restores the tree stored in a snapshot; graph must have been created from the same snapshot
+        PackedRTree(const Graph &graph, const GraphSnapshot &snapshot);
+
+        // Same results as Quadtree::getClosestEdges: the resultCount closest segments by distance, or with
+        // multipleSegments == false only the closest segment of each edge
+        std::vector<ClosestEdges> getClosestEdges(const Coordinates &point, uint8_t resultCount = 1, bool multipleSegments = true) const;
+
+        // getClosestEdges for many points at once, e.g. all points of a track. The points are visited along a Hilbert curve,
+        // so consecutive searches touch the same nodes and each one starts from the results of its predecessor.
+        // Runs on threadCount threads (0 uses all hardware threads).
+        ClosestEdgesBatch getClosestEdgesBatch(std::span<const Coordinates> points, uint8_t resultCount = 1, bool multipleSegments = true, unsigned threadCount = 0) const;
+
+        // All segments at most radius metres from the point, closest first, or with multipleSegments == false only the closest
+        // segment of each edge. Unlike getClosestEdges there is no placeholder entry at the end.
+        std::vector<ClosestEdges> withinRadius(const Coordinates &point, double radius, bool multipleSegments = true) const;
+
+        const Box &getBoundary() const { return mBoundary; }
+        size_t getSegmentCount() const { return mItems.size(); }
+        size_t getLevelCount() const { return mLevelOffsets.empty() ? 0 : mLevelOffsets.size() - 1; }
+
+    private:
+        friend class GraphSnapshot;
+
+        static constexpr uint32_t NODE_SIZE = 16;
+        // Consecutive points in Hilbert order handed to a thread at a time
+        static constexpr uint32_t BATCH_CHUNK_SIZE = 1024;
+
+        struct Item
+        {
+            Edge *edge;
+            uint8_t subwayId;
+        };
+
+        // Boxes of level l are [mLevelOffsets[l], mLevelOffsets[l + 1]); level 0 holds the segments, the last level the root
+        std::vector<int32_t> mMinLatitudes;
+        std::vector<int32_t> mMinLongitudes;
+        std::vector<int32_t> mMaxLatitudes;
+        std::vector<int32_t> mMaxLongitudes;
+        std::vector<uint32_t> mLevelOffsets;
+
+        // Segment of every level 0 box
+        std::vector<Item> mItems;
+        // First child of every node box, indexed by box - mItems.size(); the children are the following NODE_SIZE boxes of the level below
+        std::vector<uint32_t> mFirstChildren;
+
+        // Start and direction of every segment in degrees, relative to the minimum corner of its leaf, one array per
+        // coordinate and padded to whole leaves for the vector loads of the kernel
+        std::vector<float> mSegmentStartLatitudes;
+        std::vector<float> mSegmentStartLongitudes;
+        std::vector<float> mSegmentDeltaLatitudes;
+        std::vector<float> mSegmentDeltaLongitudes;
+
+        Box mBoundary;
+
+        // Buffers of a search, reused by the queries of one thread
+        struct SearchState
+        {
+            std::vector<std::pair<double, uint32_t>> queue;
+            std::vector<ClosestEdges> closestEdges;
+        };
+
+        double getBoxDistance(const Coordinates &point, uint32_t box) const;
+        void compileLeafSegments();
+        // Squared planar distances from the point to the NODE_SIZE segment slots of a leaf, in degrees of latitude
+        void computeLeafDistances(const Coordinates &point, uint32_t leaf, float cosLatitude, float *squaredDistances) const;
+
+        // Leaves the results in state.closestEdges; the segments in hints are measured first and bound the search from the start
+        void findClosestEdges(const Coordinates &point, uint8_t resultCount, bool multipleSegments, SearchState &state, std::span<const ClosestEdges> hints) const;
+};
@@ -1,22 +1,75 @@
 #pragma once
 
-#include <unordered_map>
 #include <string>
 #include <string_view>
 #include <cstdint>
-#include <array>
+#include <span>
+#include <utility>
+#include <vector>
 
+#include "tagdictionary.hpp"
+
+// Read-only range over the tags of a Parameters object as (key, value) strings, ordered by key ID
+class ParameterView
+{
+    public:
+        class Iterator
+        {
+            public:
+                using value_type = std::pair<std::string_view, std::string_view>;
+                using difference_type = std::ptrdiff_t;
+
+                Iterator() = default;
+                explicit Iterator(const Tag *tag) : mTag(tag) {}
+
+                value_type operator*() const
+                {
+                    const TagDictionary &dictionary = TagDictionary::getInstance();
+                    return {dictionary.getString(mTag->key), dictionary.getString(mTag->value)};
+                }
+                Iterator &operator++() { mTag++; return *this; }
+                Iterator operator++(int) { Iterator previous = *this; mTag++; return previous; }
+                bool operator==(const Iterator &other) const = default;
+
+            private:
+                const Tag *mTag = nullptr;
+        };
+
+        explicit ParameterView(std::span<const Tag> tags) : mTags(tags) {}
+
+        Iterator begin() const { return Iterator(mTags.data()); }
+        Iterator end() const { return Iterator(mTags.data() + mTags.size()); }
+        size_t size() const { return mTags.size(); }
+        bool empty() const { return mTags.empty(); }
+
+        bool operator==(const ParameterView &other) const { return std::equal(mTags.begin(), mTags.end(), other.mTags.begin(), other.mTags.end()); }
+
+    private:
+        std::span<const Tag> mTags;
+};
+
+// Tags of a way or edge, stored as the ID of an interned tag set; copies and comparisons are integer operations
 class Parameters
 {
     public:
         Parameters() = default;
 
-        const std::unordered_map<std::string, std::string> &getParameters() const { return parameters; }
+        // Tags in any order; for repeated keys the last value wins
+        explicit Parameters(std::vector<Tag> tags);
+
+        ParameterView getParameters() const { return ParameterView(getTags()); }
+
+        // Sorted by key ID
+        std::span<const Tag> getTags() const { return TagDictionary::getInstance().getTags(mTagSetId); }
+        uint32_t getTagSetId() const { return mTagSetId; }
 
         void setParameter(const std::string &key, const std::string &value);
 
         std::string getParameter(const std::string &key) const;
+
+        bool operator==(const Parameters &other) const = default;
+
     private:
-        // Parameter maps, with entries like "highway" -> "primary"; "surface" -> "asphalt"
-        std::unordered_map<std::string, std::string> parameters;
+        // Interned set of parameters like "highway" -> "primary"; "surface" -> "asphalt"
+        uint32_t mTagSetId = TagDictionary::EMPTY_TAG_SET;
 };
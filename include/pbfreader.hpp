@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "osmblock.hpp"
+
+// Reader for OpenStreetMap .osm.pbf files: zlib-compressed blobs of protobuf-encoded primitive blocks.
+// Blobs are inflated and decoded on several threads; the decoded blocks are handed out in file order.
+class PbfReader
+{
+    public:
+        // Only way tags whose key is in wayKeys are decoded; node tags and relations are skipped.
+        // Throws std::runtime_error if the file cannot be opened or needs an unsupported feature.
+        PbfReader(const std::string &filepath, std::vector<std::string> wayKeys, OsmBlock::Content content = OsmBlock::ALL);
+
+        // Calls consumer with every data block in file order; threadCount 0 uses all hardware threads
+        void read(const std::function<void(OsmBlock &&)> &consumer, unsigned threadCount = 0);
+
+    private:
+        struct RawBlob
+        {
+            std::string data;
+            uint32_t rawSize = 0;
+            bool compressed = false;
+        };
+
+        std::ifstream mFile;
+        std::string mFilepath;
+        std::vector<std::string> mWayKeys;
+        OsmBlock::Content mContent;
+
+        // Next blob of the given type; false at end of file
+        bool readBlob(std::string &type, RawBlob &blob);
+
+        std::string inflate(const RawBlob &blob) const;
+        void checkHeader(const std::string &data) const;
+        OsmBlock decodeBlock(const std::string &data) const;
+};
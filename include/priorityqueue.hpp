@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+// Open sets for the A* search. All share one interface:
+//   reset(nodeCount)  prepares an empty queue for node indices below nodeCount
+//   push(node, key)   inserts node, or lowers its key if the queue supports decrease-key
+//   pop()             removes and returns a node with the smallest key
+// Queues without decrease-key may return a node more than once; the search skips settled nodes.
+
+enum class PriorityQueue
+{
+    BinaryHeap,                                              // std::priority_queue with lazy deletion
+    QuaternaryHeap,                                          // indexed 4-ary heap with decrease-key
+    RadixHeap                                                // monotone radix heap on integer millimeter keys
+};
+
+class BinaryHeap
+{
+    public:
+        void reset(uint32_t) { mQueue = {}; }
+        bool empty() const { return mQueue.empty(); }
+
+        void push(uint32_t node, double key) { mQueue.push({key, node}); }
+
+        uint32_t pop()
+        {
+            const uint32_t node = mQueue.top().node;
+            mQueue.pop();
+            return node;
+        }
+
+    private:
+        // Double keys: float keys merge costs closer than their precision, so a node could be settled before one with a
+        // slightly smaller cost
+        struct Entry
+        {
+            double key;
+            uint32_t node;
+
+            bool operator>(const Entry &other) const { return key > other.key; }
+        };
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> mQueue;
+};
+
+class QuaternaryHeap
+{
+    public:
+        void reset(uint32_t nodeCount)
+        {
+            for(const Entry &entry : mHeap) mPositions[entry.node] = NOT_IN_HEAP;
+            mHeap.clear();
+            if(mPositions.size() < nodeCount) mPositions.resize(nodeCount, NOT_IN_HEAP);
+        }
+
+        bool empty() const { return mHeap.empty(); }
+
+        void push(uint32_t node, double key)
+        {
+            uint32_t position = mPositions[node];
+            if(position == NOT_IN_HEAP)
+            {
+                position = static_cast<uint32_t>(mHeap.size());
+                mHeap.push_back({key, node});
+            }
+            else if(key < mHeap[position].key)
+            {
+                mHeap[position].key = key;
+            }
+            else
+            {
+                return;
+            }
+            siftUp(position);
+        }
+
+        uint32_t pop()
+        {
+            const uint32_t node = mHeap.front().node;
+            mPositions[node] = NOT_IN_HEAP;
+
+            const Entry last = mHeap.back();
+            mHeap.pop_back();
+            if(!mHeap.empty())
+            {
+                mHeap.front() = last;
+                mPositions[last.node] = 0;
+                siftDown(0);
+            }
+            return node;
+        }
+
+    private:
+        static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+
+        struct Entry
+        {
+            double key;
+            uint32_t node;
+        };
+
+        std::vector<Entry> mHeap;
+        std::vector<uint32_t> mPositions;
+
+        void siftUp(uint32_t position)
+        {
+            const Entry entry = mHeap[position];
+            while(position > 0)
+            {
+                const uint32_t parent = (position - 1) / 4;
+                if(mHeap[parent].key <= entry.key) break;
+                mHeap[position] = mHeap[parent];
+                mPositions[mHeap[position].node] = position;
+                position = parent;
+            }
+            mHeap[position] = entry;
+            mPositions[entry.node] = position;
+        }
+
+        void siftDown(uint32_t position)
+        {
+            const Entry entry = mHeap[position];
+            const uint32_t size = static_cast<uint32_t>(mHeap.size());
+            while(true)
+            {
+                const uint32_t firstChild = 4 * position + 1;
+                if(firstChild >= size) break;
+
+                uint32_t smallest = firstChild;
+                const uint32_t lastChild = std::min(firstChild + 4, size);
+                for(uint32_t child = firstChild + 1; child < lastChild; child++)
+                {
+                    if(mHeap[child].key < mHeap[smallest].key) smallest = child;
+                }
+                if(entry.key <= mHeap[smallest].key) break;
+
+                mHeap[position] = mHeap[smallest];
+                mPositions[mHeap[position].node] = position;
+                position = smallest;
+            }
+            mHeap[position] = entry;
+            mPositions[entry.node] = position;
+        }
+};
+
+// Keys must not drop below the last popped key, which holds for A* with a consistent potential.
+// Keys are rounded to millimeters and clamped to the last popped key to absorb rounding of the potential.
+class RadixHeap
+{
+    public:
+        void reset(uint32_t)
+        {
+            for(auto &bucket : mBuckets) bucket.clear();
+            mLast = 0;
+            mSize = 0;
+        }
+
+        bool empty() const { return mSize == 0; }
+
+        void push(uint32_t node, double key)
+        {
+            const uint64_t millimeters = std::max(mLast, static_cast<uint64_t>(std::llround(key * 1000.0)));
+            mBuckets[getBucket(millimeters)].push_back({millimeters, node});
+            mSize++;
+        }
+
+        uint32_t pop()
+        {
+            if(mBuckets[0].empty())
+            {
+                // Redistribute the first non-empty bucket around its minimum; all its entries move to lower buckets
+                size_t bucketIndex = 1;
+                while(mBuckets[bucketIndex].empty()) bucketIndex++;
+
+                auto &bucket = mBuckets[bucketIndex];
+                mLast = std::min_element(bucket.begin(), bucket.end(), [](const Entry &a, const Entry &b) { return a.key < b.key; })->key;
+                for(const Entry &entry : bucket)
+                {
+                    mBuckets[getBucket(entry.key)].push_back(entry);
+                }
+                bucket.clear();
+            }
+
+            const uint32_t node = mBuckets[0].back().node;
+            mBuckets[0].pop_back();
+            mSize--;
+            return node;
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t node;
+        };
+
+        std::array<std::vector<Entry>, 65> mBuckets;
+        uint64_t mLast = 0;
+        size_t mSize = 0;
+
+        size_t getBucket(uint64_t key) const { return key == mLast ? 0 : 64 - std::countl_zero(key ^ mLast); }
+};
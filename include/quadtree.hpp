@@ -12,6 +12,9 @@
 
 struct ClosestEdges;
 
+// Quadtree that keeps segments in its leaves only: a segment is stored in every leaf whose cell its bounding box overlaps,
+// so segments on a cell border do not pile up at the upper levels, and queries prune with the plain cells.
+// A leaf is only split while few of its segments would be copied into several children.
 class Quadtree
 {
     public:
@@ -19,9 +22,12 @@ class Quadtree
 
         void insert(Edge *edge, uint8_t subwayId);
 
+        // The cell of the node; the bounding boxes of its segments overlap it
         const Box &getBoundary() const { return mBoundary; }
 
-        std::vector<ClosestEdges> getClosestEdges(const Coordinates &point, uint8_t resultCount = 1, bool multipleSegments = true) const;
+        // Each segment is reported once, even if several leaves hold it.
+        // visitedNodes, if given, is increased by the number of quadtree nodes the search scanned
+        std::vector<ClosestEdges> getClosestEdges(const Coordinates &point, uint8_t resultCount = 1, bool multipleSegments = true, uint32_t *visitedNodes = nullptr) const;
         
         friend std::ostream& operator<<(std::ostream& os, const Quadtree& qt);
 
@@ -40,9 +46,11 @@ class Quadtree
         Box mBoundary;
 
         static const uint8_t MAX_ITEMS = 8;
-        static const uint8_t MAX_LEVELS = 10;
+        static const uint8_t MAX_LEVELS = 16;
 
         uint8_t mLevel;
+        // Item count of a leaf that triggers the next subdivision; doubles when a split would copy too many items
+        uint32_t mSplitThreshold = MAX_ITEMS;
 
         std::vector<std::pair<Edge *, uint8_t>> mEdgeSubwayIDs;
 
@@ -50,8 +58,10 @@ class Quadtree
 
         bool subdivide();
 
+        void insertIntoChildren(Edge *edge, uint8_t subwayId);
+
         void findClosestEdges(const Coordinates &point, uint8_t resultCount,
-                              std::vector<ClosestEdges> &closestEdges, bool multipleSegments) const;
+                              std::vector<ClosestEdges> &closestEdges, bool multipleSegments, uint32_t *visitedNodes) const;
 };
 
 struct ClosestEdges
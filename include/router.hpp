@@ -2,28 +2,131 @@
 
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "graph.hpp"
+#include "compiledprofile.hpp"
+#include "csrgraph.hpp"
+#include "graphsnapshot.hpp"
+#include "ingestfilter.hpp"
+#include "contractionhierarchy.hpp"
+#include "customizablecontractionhierarchy.hpp"
+#include "landmarks.hpp"
+#include "searchcontext.hpp"
 #include "quadtree.hpp"
+#include "packedrtree.hpp"
 #include "weights.hpp"
 
 #define NO_EDGE_SNAP_PENALTY 1000
 
+enum class RoutingMode
+{
+    AStar,
+    BidirectionalAStar,
+    ContractionHierarchy,                                    // requires prepareContractionHierarchy() or customizeContractionHierarchy(), falls back to AStar otherwise
+    ALT                                                      // A* with landmark potential; requires prepareLandmarks(), falls back to AStar otherwise
+};
+
+// Dense row-major result of Router::distanceMatrix, one row per source
+struct DistanceMatrix
+{
+    uint32_t sourceCount = 0;
+    uint32_t targetCount = 0;
+    std::vector<double> costs;                               // infinity if the target is unreachable
+    std::vector<double> lengths;                             // summed edge weights along the cheapest path, infinity if unreachable
+
+    double getCost(uint32_t source, uint32_t target) const { return costs[static_cast<size_t>(source) * targetCount + target]; }
+    double getLength(uint32_t source, uint32_t target) const { return lengths[static_cast<size_t>(source) * targetCount + target]; }
+};
+
 class Router
 {
     public:
-        Router(const std::string &osmFile, const std::string &weightCSVFile = "");
+        // Names of the built-in profiles: plain edge lengths, and the weights CSV passed to the constructor
+        static constexpr const char *DISTANCE_PROFILE = "distance";
+        static constexpr const char *DEFAULT_PROFILE = "default";
+
+        // osmFile may also be a graph snapshot written by router_snapshot, which skips parsing and graph construction.
+        // The filter selects ways, kept tags and area while an OSM file is read; snapshots are loaded as written.
+        Router(const std::string &osmFile, const std::string &weightCSVFile = "", const IngestFilter &filter = IngestFilter());
 
         Graph &getGraph() { return *mGraph; }
-        Quadtree &getQuadtree() { return *mQuadtree; }
-        Weights &getWeights() { return *mWeights; }
+        const CsrGraph &getCsrGraph() const { return *mCsrGraph; }
+        // Built from the graph on first use, since routing only needs getRTree(); not thread-safe
+        Quadtree &getQuadtree();
+        // Nearest-segment index used by the router itself; answers getClosestEdges like the Quadtree
+        const PackedRTree &getRTree() const { return *mRTree; }
+        // Area of the OSM file the graph was read from
+        const Box &getBoundary() const { return mBoundary; }
+        // Weights of DEFAULT_PROFILE
+        Weights &getWeights() { return *mDefaultProfile->weights; }
+        Weights &getWeights(const std::string &profileName) { return *findProfile(profileName).weights; }
+
+        // Registers a further weight profile over the shared graph, e.g. jogging and cycling served by one process.
+        // A profile costs a few bytes per edge instead of a copy of the graph. Not thread-safe against running queries.
+        const CompiledProfile &addProfile(const std::string &name, const std::string &weightCSVFile);
+        bool hasProfile(const std::string &name) const;
+        std::vector<std::string> getProfileNames() const;
+
+        // Per-edge costs read by the searches; a weighted profile follows Weights::setWeight immediately.
+        // Throws std::out_of_range for unknown names.
+        const CompiledProfile &getProfile(const std::string &name) const { return *findProfile(name).costs; }
+        // Recompiles the cost of an edge whose length was changed with Edge::setWeight
+        void updateEdgeCost(const Edge &edge);
+
+        // The useWeighting flags below select DEFAULT_PROFILE or DISTANCE_PROFILE; the overloads taking a profile accept any registered one.
+
+        // Loads the contraction hierarchy for the unweighted or weighted profile from next to the OSM file, building and saving it if missing or outdated.
+        // The hierarchy captures the current weights; after a setWeight, queries fall back to A* until this is called again.
+        void prepareContractionHierarchy(bool useWeighting = false);
+        void prepareContractionHierarchy(const CompiledProfile &profile);
+        // Metric-independent alternative for changing weights: the topology is contracted on the first call only,
+        // every call recomputes the arc costs from the current edge weights and Weights in parallel.
+        void customizeContractionHierarchy(bool useWeighting = true);
+        void customizeContractionHierarchy(const CompiledProfile &profile);
+
+        // Selects landmarks and computes their distance tables for the unweighted or weighted profile.
+        // Like the hierarchies, the tables capture the current weights; after a setWeight, ALT falls back to A* until this is called again.
+        void prepareLandmarks(uint32_t landmarkCount = 16, bool useWeighting = false, LandmarkSelection selection = LandmarkSelection::Avoid);
+        void prepareLandmarks(const CompiledProfile &profile, uint32_t landmarkCount = 16, LandmarkSelection selection = LandmarkSelection::Avoid);
+        const Landmarks<float> *getLandmarks(bool useWeighting = false) const;
+        const Landmarks<float> *getLandmarks(const CompiledProfile &profile) const { return getEntry(profile).landmarks.get(); }
+
+        // Open set used by the A*, ALT and bidirectional searches. BinaryHeap is the default as it was fastest in priority_queue_benchmark_test:
+        // arc cost evaluation dominates, and lazy deletion beats the index upkeep of decrease-key.
+        void setPriorityQueue(PriorityQueue priorityQueue) { mPriorityQueue = priorityQueue; }
+        PriorityQueue getPriorityQueue() const { return mPriorityQueue; }
 
-        std::vector<std::tuple<uint64_t, Coordinates>> aStar(uint64_t startId, uint64_t goalId, uint8_t snapToRoads = 0, bool useWeighting = false);
+        const ContractionHierarchy *getContractionHierarchy(bool useWeighting = false) const;
+        const ContractionHierarchy *getContractionHierarchy(const CompiledProfile &profile) const { return getEntry(profile).contractionHierarchy.get(); }
+
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(uint64_t startId, uint64_t goalId, uint8_t snapToRoads = 0, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar);
         
-        std::vector<std::tuple<uint64_t, Coordinates>> aStar(Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads = 0, bool useWeighting = false);
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads = 0, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar);
+
+        std::vector<Edge *> aStarEdges(uint64_t startId, uint64_t goalId, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar);
+
+        std::vector<Edge *> aStarEdges(Coordinates startCoords, Coordinates goalCoords, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar);
 
-        std::vector<Edge *> aStarEdges(uint64_t startId, uint64_t goalId, bool useWeighting = false);
-        std::vector<Edge *> aStarEdges(Coordinates startCoords, Coordinates goalCoords, bool useWeighting = false);
+        // Variants with caller-owned search state; several threads may route concurrently, each with its own context.
+        // Coordinate queries snap to per-query phantom nodes and leave the Graph untouched.
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(SearchContext &context, uint64_t startId, uint64_t goalId, uint8_t snapToRoads = 0, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads = 0, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<Edge *> aStarEdges(SearchContext &context, uint64_t startId, uint64_t goalId, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<Edge *> aStarEdges(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, bool useWeighting = false, RoutingMode mode = RoutingMode::AStar) const;
+
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(SearchContext &context, uint64_t startId, uint64_t goalId, const CompiledProfile &profile, uint8_t snapToRoads = 0, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<std::tuple<uint64_t, Coordinates>> aStar(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, const CompiledProfile &profile, uint8_t snapToRoads = 0, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<Edge *> aStarEdges(SearchContext &context, uint64_t startId, uint64_t goalId, const CompiledProfile &profile, RoutingMode mode = RoutingMode::AStar) const;
+        std::vector<Edge *> aStarEdges(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, const CompiledProfile &profile, RoutingMode mode = RoutingMode::AStar) const;
+        
+        // Costs and lengths from every source to every target: one Dijkstra search per source that stops once all targets are settled.
+        // Sources run in parallel, threadCount 0 uses all hardware threads. Coordinates snap to phantom nodes like in aStar.
+        DistanceMatrix distanceMatrix(const std::vector<uint64_t> &sourceIds, const std::vector<uint64_t> &targetIds, bool useWeighting = false, unsigned threadCount = 0) const;
+        DistanceMatrix distanceMatrix(const std::vector<Coordinates> &sources, const std::vector<Coordinates> &targets, bool useWeighting = false, unsigned threadCount = 0) const;
+        DistanceMatrix distanceMatrix(const std::vector<uint64_t> &sourceIds, const std::vector<uint64_t> &targetIds, const CompiledProfile &profile, unsigned threadCount = 0) const;
+        DistanceMatrix distanceMatrix(const std::vector<Coordinates> &sources, const std::vector<Coordinates> &targets, const CompiledProfile &profile, unsigned threadCount = 0) const;
         
         std::tuple<Coordinates, uint64_t, uint8_t> getEdgeSplit(Coordinates coords) const;
         
@@ -33,12 +136,71 @@ class Router
         Coordinates getClosestPointOnEdge(Coordinates coords, uint64_t edgeId, uint8_t segmentIndex) const;
 
     private:
+        // Registry entry: the weights, their compiled costs and the speed-up data prepared for them
+        struct Profile
+        {
+            std::string name;
+            std::unique_ptr<Weights> weights;                // nullptr for DISTANCE_PROFILE
+            std::unique_ptr<CompiledProfile> costs;
+            std::unique_ptr<ContractionHierarchy> contractionHierarchy;
+            std::unique_ptr<Landmarks<float>> landmarks;
+            // Weights::getRevision() when the hierarchy and the landmarks were prepared; a later setWeight makes them stale
+            uint64_t contractionHierarchyRevision = 0;
+            uint64_t landmarksRevision = 0;
+
+            uint64_t getRevision() const { return weights ? weights->getRevision() : 0; }
+        };
+
         std::unique_ptr<Graph> mGraph;
+        std::unique_ptr<CsrGraph> mCsrGraph;
+        SearchContext mSearchContext;
+        Box mBoundary{Coordinates(0.0, 0.0), Coordinates(0.0, 0.0)};
         std::unique_ptr<Quadtree> mQuadtree;
-        std::unique_ptr<Weights> mWeights;
+        std::unique_ptr<PackedRTree> mRTree;
+        // Entries stay in place, so CompiledProfile references handed out remain valid while profiles are added
+        std::vector<std::unique_ptr<Profile>> mProfiles;
+        Profile *mDistanceProfile = nullptr;
+        Profile *mDefaultProfile = nullptr;
+        std::unique_ptr<CustomizableContractionHierarchy> mCustomizableContractionHierarchy;
+        std::string mOsmFile;
+        PriorityQueue mPriorityQueue = PriorityQueue::BinaryHeap;
         
-        static double heuristic(const Node &a, const Node &b);
-        void aStarRouting(uint64_t &startId, uint64_t &goalId, uint8_t snapToRoads = 0, bool useWeighting = false);
+        static double heuristic(const Coordinates &a, const Coordinates &b);
+
+        Profile &registerProfile(const std::string &name, std::unique_ptr<Weights> weights);
+        const Profile &findProfile(const std::string &name) const;
+        // DEFAULT_PROFILE or DISTANCE_PROFILE; nullptr if weighting is requested but no weights were given
+        const Profile *getBuiltinProfile(bool useWeighting) const { return useWeighting ? mDefaultProfile : mDistanceProfile; }
+        // Like getBuiltinProfile, but warns and falls back to distances instead of returning nullptr
+        const Profile &getRoutingProfile(bool useWeighting) const;
+        const Profile &getEntry(const CompiledProfile &profile) const;
+        Profile &getEntry(const CompiledProfile &profile) { return const_cast<Profile &>(std::as_const(*this).getEntry(profile)); }
+        std::string getProfileFilename(const Profile &profile, const std::string &extension) const;
+
+        void prepareOverlay(SearchContext &context) const;
+        uint32_t addPhantomNode(SearchContext &context, const Coordinates &coords) const;
+        Coordinates getNodeCoordinates(const SearchContext &context, uint32_t nodeIndex) const;
+
+        std::vector<std::tuple<uint64_t, Coordinates>> reconstructPath(const SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const;
+        std::vector<Edge *> reconstructEdges(const SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const;
+
+        template <typename Visitor>
+        void forEachArc(const SearchContext &context, uint32_t nodeIndex, Visitor &&visitor) const;
+        static double getArcCost(const CompiledProfile &profile, const CsrGraph::Arc &arc, double weightFactor) { return profile.getCost(arc.edge) * weightFactor; }
+
+        void route(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const Profile &profile, RoutingMode mode) const;
+        void aStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const;
+        void landmarkRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const Profile &profile) const;
 
-        uint32_t currentEpoch = 0;
+        // A* with an arbitrary consistent potential: potential(nodeIndex) is a lower bound on the cost to the goal.
+        // Runs aStarSearch with the open set selected by mPriorityQueue.
+        template <typename Potential>
+        void aStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, const CompiledProfile &profile, Potential &&potential) const;
+        template <typename Queue, typename Potential>
+        void aStarSearch(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, const CompiledProfile &profile, Potential &&potential) const;
+        DistanceMatrix computeDistanceMatrix(const CsrGraph::Overlay &overlay, const std::vector<uint32_t> &sources, const std::vector<uint32_t> &targets, const Profile &matrixProfile, unsigned threadCount) const;
+        // Runs bidirectionalAStarSearch with the open set selected by mPriorityQueue
+        void bidirectionalAStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const;
+        template <typename Queue>
+        void bidirectionalAStarSearch(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "csrgraph.hpp"
+#include "priorityqueue.hpp"
+
+// Per-query search state, stored as struct-of-arrays indexed by dense node index.
+// Labels are invalidated by bumping an epoch, so a context can be reused for many queries without clearing.
+// Each thread routing on a shared Router needs its own context.
+class SearchContext
+{
+    public:
+        static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+        SearchContext() = default;
+
+        // Starts a new search over nodeCount nodes; all previous labels become stale
+        void startSearch(uint32_t nodeCount);
+
+        bool isReached(uint32_t node) const { return mEpochs[node] == mEpoch; }
+        bool isSettled(uint32_t node) const { return isReached(node) && (mFlags[node] & SETTLED); }
+
+        double getCost(uint32_t node) const { return isReached(node) ? mCosts[node] : std::numeric_limits<double>::infinity(); }
+        uint32_t getParent(uint32_t node) const { return isReached(node) ? mParents[node] : INVALID_INDEX; }
+        uint32_t getParentEdge(uint32_t node) const { return isReached(node) ? mParentEdges[node] : INVALID_INDEX; }
+        bool isParentEdgeReversed(uint32_t node) const { return isReached(node) && (mFlags[node] & PARENT_EDGE_REVERSED); }
+
+        void setLabel(uint32_t node, double cost, uint32_t parent, uint32_t parentEdge, bool parentEdgeReversed)
+        {
+            mEpochs[node] = mEpoch;
+            mCosts[node] = cost;
+            mParents[node] = parent;
+            mParentEdges[node] = parentEdge;
+            mFlags[node] = parentEdgeReversed ? PARENT_EDGE_REVERSED : 0;
+        }
+
+        void settle(uint32_t node) { mFlags[node] |= SETTLED; }
+
+        // Arcs of split items and phantom nodes that are not part of the CSR arrays
+        CsrGraph::Overlay &getOverlay() { return mOverlay; }
+        const CsrGraph::Overlay &getOverlay() const { return mOverlay; }
+
+        // Open set of the given queue type, kept so its buffers are reused across queries
+        template <typename Queue>
+        Queue &getQueue() { return std::get<Queue>(mQueues); }
+
+        // Labels of the backward search in bidirectional mode; created on first use
+        SearchContext &getBackwardContext();
+
+    private:
+        static constexpr uint8_t SETTLED = 1;
+        static constexpr uint8_t PARENT_EDGE_REVERSED = 2;
+
+        std::vector<double> mCosts;
+        std::vector<uint32_t> mParents;
+        std::vector<uint32_t> mParentEdges;
+        std::vector<uint8_t> mFlags;
+        std::vector<uint32_t> mEpochs;
+        uint32_t mEpoch = 0;
+
+        CsrGraph::Overlay mOverlay;
+
+        std::tuple<BinaryHeap, QuaternaryHeap, RadixHeap> mQueues;
+
+        std::unique_ptr<SearchContext> mBackwardContext;
+};
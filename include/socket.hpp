@@ -4,6 +4,8 @@
 #include <cstddef>
 #include <string>
 
+#include "searchcontext.hpp"
+
 class Router;
 
 namespace socketcpp
@@ -21,6 +23,7 @@ private:
     void handleClient(int clientFd);
 
     Router &mRouter;
+    SearchContext mSearchContext;
     uint16_t mPort;
     size_t mPathCounter;
 };
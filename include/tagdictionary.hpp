@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <ankerl/unordered_dense.h>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// OSM tag as a pair of interned strings
+struct Tag
+{
+    uint32_t key;
+    uint32_t value;
+
+    bool operator==(const Tag &other) const = default;
+};
+
+// Process-wide dictionary interning tag strings and whole tag sets into small integer IDs.
+// Maps have only a few hundred distinct tag combinations, so an edge needs nothing but the ID of its set.
+// Interned strings and sets are never removed, views into them stay valid. All methods are thread-safe.
+class TagDictionary
+{
+    public:
+        static constexpr uint32_t INVALID_ID = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t EMPTY_TAG_SET = 0;
+
+        static TagDictionary &getInstance();
+
+        uint32_t intern(std::string_view string);
+        // INVALID_ID if the string was never interned
+        uint32_t find(std::string_view string) const;
+        std::string_view getString(uint32_t id) const;
+
+        // tags must be sorted by key without repeated keys
+        uint32_t internTags(std::span<const Tag> tags);
+        std::span<const Tag> getTags(uint32_t tagSetId) const;
+
+        size_t getStringCount() const;
+        size_t getTagSetCount() const;
+
+    private:
+        TagDictionary();
+
+        struct TagSetHash
+        {
+            using is_avalanching = void;
+            uint64_t operator()(std::span<const Tag> tags) const
+            {
+                return ankerl::unordered_dense::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(tags.data()), tags.size_bytes()));
+            }
+        };
+
+        struct TagSetEqual
+        {
+            bool operator()(std::span<const Tag> a, std::span<const Tag> b) const
+            {
+                return std::equal(a.begin(), a.end(), b.begin(), b.end());
+            }
+        };
+
+        mutable std::shared_mutex mMutex;
+
+        // Deques keep the stored strings and sets in place, so the maps can key on views into them
+        std::deque<std::string> mStrings;
+        ankerl::unordered_dense::map<std::string_view, uint32_t> mStringIds;
+        std::deque<std::vector<Tag>> mTagSets;
+        ankerl::unordered_dense::map<std::span<const Tag>, uint32_t, TagSetHash, TagSetEqual> mTagSetIds;
+};
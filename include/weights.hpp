@@ -1,7 +1,11 @@
 #pragma once
 
 #include <ankerl/unordered_dense.h>
+#include <cstdint>
+#include <functional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "parameters.hpp"
 
@@ -11,21 +15,29 @@ class Weights
         Weights(const std::string &weightsCSVFile);
 
         double getWeight(const Parameters &parameters) const;
+        double getWeight(std::span<const Tag> tags) const;
         double getWeight(const std::string &key, const std::string &value) const;
 
-        void setWeight(const std::string &key, const std::string &value, double weight)
-        {
-            mWeights[key][value] = weight;
-        }
+        void setWeight(const std::string &key, const std::string &value, double weight);
+
+        // Called with the tag of every setWeight that changes a value, e.g. to recompile the costs derived from these weights
+        void addChangeListener(std::function<void(const Tag &)> listener) { mChangeListeners.push_back(std::move(listener)); }
 
         void saveWeights(const std::string &filename);
 
+        // Counts the setWeight calls that changed a value
+        uint64_t getRevision() const { return mRevision; }
+
+        // Interned tag as a single map key: key ID << 32 | value ID
+        static uint64_t getTagKey(const Tag &tag) { return static_cast<uint64_t>(tag.key) << 32 | tag.value; }
+
     private:
         // a map of parameter types, e.g. "highway", to a map of parameter values, e.g. "primary", to their corresponding weights
         ankerl::unordered_dense::map<std::string, ankerl::unordered_dense::map<std::string, double>> mWeights;
+        // The same weights keyed by interned tag, so edges are weighted without hashing strings
+        ankerl::unordered_dense::map<uint64_t, double> mTagWeights;
+        uint64_t mRevision = 0;
+        std::vector<std::function<void(const Tag &)>> mChangeListeners;
 
-        ankerl::unordered_dense::map<std::string, double> getKeyWeights(const std::string &key) const;
-
-        
         static constexpr double fallbackWeight = 0.0;
 };
\ No newline at end of file
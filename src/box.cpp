@@ -6,10 +6,10 @@
 
 Box::Box(const Coordinates &topLeft, const Coordinates &bottomRight)
 {
-    mMinLatitude = std::min(topLeft.getLatitude(), bottomRight.getLatitude());
-    mMinLongitude = std::min(topLeft.getLongitude(), bottomRight.getLongitude());
-    mMaxLatitude = std::max(topLeft.getLatitude(), bottomRight.getLatitude());
-    mMaxLongitude = std::max(topLeft.getLongitude(), bottomRight.getLongitude());
+    mMinLatitude = std::min(topLeft.getFixedLatitude(), bottomRight.getFixedLatitude());
+    mMinLongitude = std::min(topLeft.getFixedLongitude(), bottomRight.getFixedLongitude());
+    mMaxLatitude = std::max(topLeft.getFixedLatitude(), bottomRight.getFixedLatitude());
+    mMaxLongitude = std::max(topLeft.getFixedLongitude(), bottomRight.getFixedLongitude());
 }
 
 bool Box::overlaps(const Box &other) const
@@ -20,8 +20,8 @@ bool Box::overlaps(const Box &other) const
 
 bool Box::contains(const Coordinates &point) const
 {
-    return mMinLatitude <= point.getLatitude() && point.getLatitude() <= mMaxLatitude
-        && mMinLongitude <= point.getLongitude() && point.getLongitude() <= mMaxLongitude;
+    return mMinLatitude <= point.getFixedLatitude() && point.getFixedLatitude() <= mMaxLatitude
+        && mMinLongitude <= point.getFixedLongitude() && point.getFixedLongitude() <= mMaxLongitude;
 }
 
 bool Box::contains(const Box &other) const
@@ -31,14 +31,14 @@ bool Box::contains(const Box &other) const
 
 double Box::getDistance(const Coordinates &point) const
 {
-    double lat = std::max(mMinLatitude, std::min(point.getLatitude(), mMaxLatitude));
-    double lon = std::max(mMinLongitude, std::min(point.getLongitude(), mMaxLongitude));
-    return HelperFunctions::haversine(point, Coordinates(lat, lon));
+    const int32_t lat = std::clamp(point.getFixedLatitude(), mMinLatitude, mMaxLatitude);
+    const int32_t lon = std::clamp(point.getFixedLongitude(), mMinLongitude, mMaxLongitude);
+    return HelperFunctions::haversine(point, Coordinates::fromFixedPoint(lat, lon));
 }
 
 double Box::getEstDistanceSquared(const Coordinates &point) const
 {
-    double lat = std::max(mMinLatitude, std::min(point.getLatitude(), mMaxLatitude));
-    double lon = std::max(mMinLongitude, std::min(point.getLongitude(), mMaxLongitude));
-    return HelperFunctions::euclideanDistanceSquared(point, Coordinates(lat, lon));
+    const int32_t lat = std::clamp(point.getFixedLatitude(), mMinLatitude, mMaxLatitude);
+    const int32_t lon = std::clamp(point.getFixedLongitude(), mMinLongitude, mMaxLongitude);
+    return HelperFunctions::euclideanDistanceSquared(point, Coordinates::fromFixedPoint(lat, lon));
 }
@@ -0,0 +1,115 @@
+#include "compiledprofile.hpp"
+
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "weights.hpp"
+
+CompiledProfile::CompiledProfile(const Graph &graph, const Weights *weights) : mGraph(graph), mWeights(weights), mEdgeCount(graph.getEdgeCount())
+{
+    if(!graph.getSplitItemIds().empty())
+    {
+        throw std::logic_error("Compiled profile must be built before split items are added");
+    }
+
+    mCosts.resize(mEdgeCount);
+    mEdgeTagSets.resize(mEdgeCount);
+
+    ankerl::unordered_dense::map<uint32_t, uint32_t> localTagSets;
+    for(uint32_t edgeIndex = 0; edgeIndex < mEdgeCount; edgeIndex++)
+    {
+        const uint32_t tagSetId = graph.getEdgeByIndex(edgeIndex)->getParameters().getTagSetId();
+        auto [it, inserted] = localTagSets.try_emplace(tagSetId, static_cast<uint32_t>(mTagSetIds.size()));
+        if(inserted)
+        {
+            mTagSetIds.push_back(tagSetId);
+        }
+        mEdgeTagSets[edgeIndex] = it->second;
+    }
+
+    const uint32_t tagSetCount = static_cast<uint32_t>(mTagSetIds.size());
+    mTagSetWeights.resize(tagSetCount, 0.0);
+    mTagSetEdgeOffsets.assign(tagSetCount + 1, 0);
+    for(uint32_t tagSet : mEdgeTagSets)
+    {
+        mTagSetEdgeOffsets[tagSet + 1]++;
+    }
+    for(uint32_t tagSet = 0; tagSet < tagSetCount; tagSet++)
+    {
+        mTagSetEdgeOffsets[tagSet + 1] += mTagSetEdgeOffsets[tagSet];
+    }
+
+    mTagSetEdges.resize(mEdgeCount);
+    std::vector<uint32_t> position(mTagSetEdgeOffsets.begin(), mTagSetEdgeOffsets.end() - 1);
+    for(uint32_t edgeIndex = 0; edgeIndex < mEdgeCount; edgeIndex++)
+    {
+        mTagSetEdges[position[mEdgeTagSets[edgeIndex]]++] = edgeIndex;
+    }
+
+    if(weights)
+    {
+        const TagDictionary &dictionary = TagDictionary::getInstance();
+        for(uint32_t tagSet = 0; tagSet < tagSetCount; tagSet++)
+        {
+            const std::span<const Tag> tags = dictionary.getTags(mTagSetIds[tagSet]);
+            mTagSetWeights[tagSet] = weights->getWeight(tags);
+            for(const Tag &tag : tags)
+            {
+                mTagSetsByTag[Weights::getTagKey(tag)].push_back(tagSet);
+            }
+        }
+    }
+
+    for(uint32_t edgeIndex = 0; edgeIndex < mEdgeCount; edgeIndex++)
+    {
+        mCosts[edgeIndex] = computeCost(*graph.getEdgeByIndex(edgeIndex), mTagSetWeights[mEdgeTagSets[edgeIndex]]);
+    }
+}
+
+float CompiledProfile::computeCost(const Edge &edge, double weight) const
+{
+    return static_cast<float>(edge.getWeight() + edge.getWeight() * weight);
+}
+
+float CompiledProfile::getSplitItemCost(uint32_t edgeIndex) const
+{
+    const Edge &edge = *mGraph.getEdgeByIndex(edgeIndex);
+    return computeCost(edge, mWeights ? mWeights->getWeight(edge.getParameters()) : 0.0);
+}
+
+bool CompiledProfile::updateTag(const Tag &tag)
+{
+    auto it = mTagSetsByTag.find(Weights::getTagKey(tag));
+    if(!mWeights || it == mTagSetsByTag.end())
+    {
+        return false;
+    }
+
+    bool changed = false;
+    const TagDictionary &dictionary = TagDictionary::getInstance();
+    for(uint32_t tagSet : it->second)
+    {
+        const double weight = mWeights->getWeight(dictionary.getTags(mTagSetIds[tagSet]));
+        if(weight == mTagSetWeights[tagSet])
+            continue;
+
+        mTagSetWeights[tagSet] = weight;
+        for(uint32_t position = mTagSetEdgeOffsets[tagSet]; position < mTagSetEdgeOffsets[tagSet + 1]; position++)
+        {
+            const uint32_t edgeIndex = mTagSetEdges[position];
+            mCosts[edgeIndex] = computeCost(*mGraph.getEdgeByIndex(edgeIndex), weight);
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+void CompiledProfile::updateEdge(const Edge &edge)
+{
+    // Split items are costed on access and need no update
+    const uint32_t edgeIndex = edge.getIndex();
+    if(edgeIndex < mEdgeCount)
+    {
+        mCosts[edgeIndex] = computeCost(edge, mTagSetWeights[mEdgeTagSets[edgeIndex]]);
+    }
+}
@@ -0,0 +1,676 @@
+#include "contractionhierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+
+#include "graph.hpp"
+#include "weights.hpp"
+
+namespace
+{
+    constexpr char FILE_MAGIC[4] = {'R', 'C', 'H', '1'};
+    constexpr uint32_t FILE_VERSION = 1;
+
+    // Witness searches give up after this many settled nodes; a missed witness only costs an extra shortcut.
+    // Simulated contractions only estimate the node order and use a tighter limit.
+    constexpr uint32_t WITNESS_SETTLE_LIMIT = 500;
+    constexpr uint32_t SIMULATION_SETTLE_LIMIT = 50;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t nodeCount;
+        uint32_t edgeCount;
+        uint64_t costHash;
+        uint64_t arcCount;
+    };
+
+    void flip(ContractionHierarchy::Arc &arc)
+    {
+        std::swap(arc.source, arc.target);
+        std::swap(arc.sourceChild, arc.targetChild);
+        if(arc.edge != ContractionHierarchy::INVALID_INDEX)
+        {
+            arc.reversed = !arc.reversed;
+        }
+    }
+
+    // Graph used during contraction; each undirected connection is one arc referenced from both endpoints
+    class ContractionGraph
+    {
+        public:
+            struct Link
+            {
+                uint32_t node;
+                uint32_t arc;
+            };
+
+            // Result of a simulated contraction, used for the node order
+            struct Estimate
+            {
+                int shortcuts = 0;
+                int shortcutHops = 0;                        // original edges represented by the new shortcuts
+            };
+
+            explicit ContractionGraph(uint32_t nodeCount) : mAdjacency(nodeCount), mDistances(nodeCount, std::numeric_limits<double>::infinity()), mTargetMarks(nodeCount, 0) {}
+
+            std::vector<ContractionHierarchy::Arc> arcs;
+            std::vector<uint32_t> hops;
+
+            const std::vector<Link> &getLinks(uint32_t node) const { return mAdjacency[node]; }
+
+            // Inserts a connection or lowers the cost of an existing one between two uncontracted nodes
+            void upsert(const ContractionHierarchy::Arc &arc, uint32_t arcHops)
+            {
+                for(Link &link : mAdjacency[arc.source])
+                {
+                    if(link.node == arc.target)
+                    {
+                        if(arcs[link.arc].cost > arc.cost)
+                        {
+                            arcs[link.arc] = arc;
+                            hops[link.arc] = arcHops;
+                        }
+                        return;
+                    }
+                }
+
+                const uint32_t arcIndex = static_cast<uint32_t>(arcs.size());
+                arcs.push_back(arc);
+                hops.push_back(arcHops);
+                mAdjacency[arc.source].push_back({arc.target, arcIndex});
+                mAdjacency[arc.target].push_back({arc.source, arcIndex});
+            }
+
+            // Detaches a contracted node and returns its remaining links, which become its upward arcs
+            std::vector<Link> remove(uint32_t node)
+            {
+                std::vector<Link> links = std::move(mAdjacency[node]);
+                mAdjacency[node].clear();
+
+                for(const Link &link : links)
+                {
+                    auto &neighborLinks = mAdjacency[link.node];
+                    neighborLinks.erase(std::remove_if(neighborLinks.begin(), neighborLinks.end(), [node](const Link &l) { return l.node == node; }), neighborLinks.end());
+                }
+                return links;
+            }
+
+            // Local Dijkstra from source that ignores the node being contracted; returns distances via getDistance().
+            // Stops once all nodes marked with the current target mark are settled.
+            void witnessSearch(uint32_t source, uint32_t ignoredNode, double maxCost, uint32_t targetCount, uint32_t settleLimit)
+            {
+                for(uint32_t node : mTouched) mDistances[node] = std::numeric_limits<double>::infinity();
+                mTouched.clear();
+
+                using QueueItem = std::pair<double, uint32_t>;
+                std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+                mDistances[source] = 0;
+                mTouched.push_back(source);
+                queue.emplace(0.0, source);
+
+                uint32_t settled = 0;
+                while(!queue.empty() && settled < settleLimit)
+                {
+                    auto [distance, node] = queue.top();
+                    queue.pop();
+
+                    if(distance > mDistances[node]) continue;
+                    if(distance > maxCost) break;
+                    settled++;
+
+                    if(mTargetMarks[node] == mTargetMark && --targetCount == 0) break;
+
+                    for(const Link &link : mAdjacency[node])
+                    {
+                        if(link.node == ignoredNode) continue;
+
+                        const double newDistance = distance + arcs[link.arc].cost;
+                        if(newDistance < mDistances[link.node])
+                        {
+                            if(std::isinf(mDistances[link.node])) mTouched.push_back(link.node);
+                            mDistances[link.node] = newDistance;
+                            queue.emplace(newDistance, link.node);
+                        }
+                    }
+                }
+            }
+
+            double getDistance(uint32_t node) const { return mDistances[node]; }
+
+            // Contracts node (or only counts the shortcuts if simulate is set)
+            Estimate contractNode(uint32_t node, bool simulate)
+            {
+                const std::vector<Link> links = mAdjacency[node];
+                Estimate estimate;
+
+                for(size_t i = 0; i < links.size(); i++)
+                {
+                    const double costToNode = arcs[links[i].arc].cost;
+
+                    if(i + 1 == links.size()) break;
+
+                    mTargetMark++;
+                    double maxCost = 0;
+                    for(size_t j = i + 1; j < links.size(); j++)
+                    {
+                        maxCost = std::max(maxCost, costToNode + arcs[links[j].arc].cost);
+                        mTargetMarks[links[j].node] = mTargetMark;
+                    }
+
+                    witnessSearch(links[i].node, node, maxCost, static_cast<uint32_t>(links.size() - i - 1), simulate ? SIMULATION_SETTLE_LIMIT : WITNESS_SETTLE_LIMIT);
+
+                    for(size_t j = i + 1; j < links.size(); j++)
+                    {
+                        const double viaCost = costToNode + arcs[links[j].arc].cost;
+                        if(getDistance(links[j].node) <= viaCost) continue;
+
+                        const uint32_t shortcutHops = hops[links[i].arc] + hops[links[j].arc];
+                        estimate.shortcuts++;
+                        estimate.shortcutHops += shortcutHops;
+                        if(simulate) continue;
+
+                        // Orient both children as middle -> endpoint
+                        ContractionHierarchy::Arc &first = arcs[links[i].arc];
+                        if(first.source != node) flip(first);
+                        ContractionHierarchy::Arc &second = arcs[links[j].arc];
+                        if(second.source != node) flip(second);
+
+                        upsert({links[i].node, links[j].node, viaCost, ContractionHierarchy::INVALID_INDEX, 0, links[i].arc, links[j].arc}, shortcutHops);
+                    }
+                }
+                return estimate;
+            }
+
+        private:
+            std::vector<std::vector<Link>> mAdjacency;
+            std::vector<double> mDistances;
+            std::vector<uint32_t> mTouched;
+            std::vector<uint32_t> mTargetMarks;
+            uint32_t mTargetMark = 0;
+    };
+}
+
+ContractionHierarchy::ContractionHierarchy(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights)
+{
+    mEdgeCosts = computeEdgeCosts(graph, csrGraph, weights);
+    mCostHash = hashCosts(csrGraph, mEdgeCosts);
+    mWeighted = weights != nullptr;
+
+    contract(csrGraph);
+}
+
+std::unique_ptr<ContractionHierarchy> ContractionHierarchy::loadOrBuild(const std::string &filename, const Graph &graph, const CsrGraph &csrGraph, const Weights *weights)
+{
+    std::unique_ptr<ContractionHierarchy> hierarchy(new ContractionHierarchy());
+    hierarchy->mEdgeCosts = computeEdgeCosts(graph, csrGraph, weights);
+    hierarchy->mCostHash = hashCosts(csrGraph, hierarchy->mEdgeCosts);
+    hierarchy->mWeighted = weights != nullptr;
+
+    if(hierarchy->load(filename, csrGraph))
+    {
+        return hierarchy;
+    }
+
+    hierarchy->contract(csrGraph);
+    if(!hierarchy->save(filename))
+    {
+        std::cerr << "Could not save contraction hierarchy to " << filename << "\n";
+    }
+    return hierarchy;
+}
+
+std::vector<double> ContractionHierarchy::computeEdgeCosts(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights)
+{
+    std::vector<double> edgeCosts(csrGraph.getEdgeCount());
+    for(uint32_t edgeIndex = 0; edgeIndex < csrGraph.getEdgeCount(); edgeIndex++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        edgeCosts[edgeIndex] = edge->getWeight() + edge->getWeight() * (weights ? weights->getWeight(edge->getParameters()) : 0.0);
+    }
+    return edgeCosts;
+}
+
+uint64_t ContractionHierarchy::hashCosts(const CsrGraph &csrGraph, const std::vector<double> &edgeCosts)
+{
+    // FNV-1a over topology and costs
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void *data, size_t size)
+    {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for(size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    for(uint32_t node = 0; node < csrGraph.getNodeCount(); node++)
+    {
+        for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+        {
+            const uint32_t target = arc.target;
+            add(&target, sizeof(target));
+        }
+    }
+    add(edgeCosts.data(), edgeCosts.size() * sizeof(double));
+    return hash;
+}
+
+void ContractionHierarchy::contract(const CsrGraph &csrGraph)
+{
+    const uint32_t nodeCount = csrGraph.getNodeCount();
+    ContractionGraph contractionGraph(nodeCount);
+
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+        {
+            if(arc.reversed || arc.target == node) continue;
+            contractionGraph.upsert({node, arc.target, mEdgeCosts[arc.edge], arc.edge, 0, INVALID_INDEX, INVALID_INDEX}, 1);
+        }
+    }
+
+    std::vector<uint32_t> levels(nodeCount, 0);
+    std::vector<float> priorities(nodeCount, 0);
+    std::vector<bool> contracted(nodeCount, false);
+
+    // Added per removed arcs and hops plus the hierarchy level; keeps the remaining core sparse and the hierarchy flat
+    auto priorityOf = [&](uint32_t node)
+    {
+        const auto &links = contractionGraph.getLinks(node);
+        if(links.empty()) return static_cast<float>(levels[node]);
+
+        uint32_t removedHops = 0;
+        for(const auto &link : links) removedHops += contractionGraph.hops[link.arc];
+
+        const auto estimate = contractionGraph.contractNode(node, true);
+        return static_cast<float>(estimate.shortcuts) / links.size() + static_cast<float>(estimate.shortcutHops) / removedHops + levels[node];
+    };
+
+    using QueueItem = std::pair<float, uint32_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        priorities[node] = priorityOf(node);
+        queue.emplace(priorities[node], node);
+    }
+
+    mRanks.assign(nodeCount, 0);
+    std::vector<std::vector<uint32_t>> upwardArcs(nodeCount);
+    uint32_t rank = 0;
+
+    while(!queue.empty())
+    {
+        auto [priority, node] = queue.top();
+        queue.pop();
+
+        if(contracted[node] || priority != priorities[node]) continue;
+
+        // Lazy update instead of re-simulating all neighbors after each contraction: refresh the priority when a node
+        // reaches the top and re-queue it if it got worse
+        priorities[node] = priorityOf(node);
+        if(!queue.empty() && priorities[node] > queue.top().first)
+        {
+            queue.emplace(priorities[node], node);
+            continue;
+        }
+
+        contractionGraph.contractNode(node, false);
+        contracted[node] = true;
+        mRanks[node] = rank++;
+
+        for(const auto &link : contractionGraph.remove(node))
+        {
+            ContractionHierarchy::Arc &arc = contractionGraph.arcs[link.arc];
+            if(arc.source != node) flip(arc);
+            upwardArcs[node].push_back(link.arc);
+
+            levels[link.node] = std::max(levels[link.node], levels[node] + 1);
+        }
+    }
+
+    // Flatten the upward arcs into CSR order and remap the shortcut children
+    std::vector<uint32_t> finalIndex(contractionGraph.arcs.size(), INVALID_INDEX);
+    mOffsets.assign(nodeCount + 1, 0);
+    mArcs.clear();
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        for(uint32_t arcIndex : upwardArcs[node])
+        {
+            finalIndex[arcIndex] = static_cast<uint32_t>(mArcs.size());
+            mArcs.push_back(contractionGraph.arcs[arcIndex]);
+        }
+        mOffsets[node + 1] = static_cast<uint32_t>(mArcs.size());
+    }
+
+    for(Arc &arc : mArcs)
+    {
+        if(arc.edge == INVALID_INDEX)
+        {
+            arc.sourceChild = finalIndex[arc.sourceChild];
+            arc.targetChild = finalIndex[arc.targetChild];
+        }
+    }
+}
+
+size_t ContractionHierarchy::getShortcutCount() const
+{
+    return std::count_if(mArcs.begin(), mArcs.end(), [](const Arc &arc) { return arc.edge == INVALID_INDEX; });
+}
+
+bool ContractionHierarchy::save(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::binary);
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.nodeCount = getNodeCount();
+    header.edgeCount = static_cast<uint32_t>(mEdgeCosts.size());
+    header.costHash = mCostHash;
+    header.arcCount = mArcs.size();
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(mRanks.data()), mRanks.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(mOffsets.data()), mOffsets.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(mArcs.data()), mArcs.size() * sizeof(Arc));
+
+    return file.good();
+}
+
+bool ContractionHierarchy::load(const std::string &filename, const CsrGraph &csrGraph)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if(!file || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_VERSION
+        || header.nodeCount != csrGraph.getNodeCount() || header.edgeCount != csrGraph.getEdgeCount() || header.costHash != mCostHash)
+    {
+        return false;
+    }
+
+    // A truncated file must not make us allocate or read an arc count it does not contain
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(filename, error);
+    const uint64_t arraySize = (2 * static_cast<uint64_t>(header.nodeCount) + 1) * sizeof(uint32_t);
+    if(error || fileSize < sizeof(header) + arraySize || (fileSize - sizeof(header) - arraySize) / sizeof(Arc) != header.arcCount
+        || (fileSize - sizeof(header) - arraySize) % sizeof(Arc) != 0)
+    {
+        return false;
+    }
+
+    mRanks.resize(header.nodeCount);
+    mOffsets.resize(header.nodeCount + 1);
+    mArcs.resize(header.arcCount);
+
+    file.read(reinterpret_cast<char *>(mRanks.data()), mRanks.size() * sizeof(uint32_t));
+    file.read(reinterpret_cast<char *>(mOffsets.data()), mOffsets.size() * sizeof(uint32_t));
+    file.read(reinterpret_cast<char *>(mArcs.data()), mArcs.size() * sizeof(Arc));
+
+    return file && isValid(header.edgeCount);
+}
+
+bool ContractionHierarchy::isValid(uint32_t edgeCount) const
+{
+    // The cost hash only matches the graph, not the file, so every index is checked before a query can follow it
+    const uint32_t nodeCount = getNodeCount();
+    std::vector<bool> rankUsed(nodeCount, false);
+    for(uint32_t rank : mRanks)
+    {
+        if(rank >= nodeCount || rankUsed[rank]) return false;
+        rankUsed[rank] = true;
+    }
+
+    if(mOffsets.front() != 0 || mOffsets.back() != mArcs.size()) return false;
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        if(mOffsets[node] > mOffsets[node + 1]) return false;
+        for(uint32_t arcIndex = mOffsets[node]; arcIndex < mOffsets[node + 1]; arcIndex++)
+        {
+            const Arc &arc = mArcs[arcIndex];
+            if(arc.source != node || arc.target >= nodeCount || mRanks[arc.source] >= mRanks[arc.target]) return false;
+        }
+    }
+
+    // Both children of a shortcut start at a lower ranked middle node, so unpacking always terminates
+    for(const Arc &arc : mArcs)
+    {
+        if(arc.edge != INVALID_INDEX)
+        {
+            if(arc.edge >= edgeCount) return false;
+            continue;
+        }
+        if(arc.sourceChild >= mArcs.size() || arc.targetChild >= mArcs.size()) return false;
+
+        const Arc &sourceChild = mArcs[arc.sourceChild];
+        const Arc &targetChild = mArcs[arc.targetChild];
+        if(sourceChild.source != targetChild.source || sourceChild.target != arc.source || targetChild.target != arc.target
+            || mRanks[sourceChild.source] >= mRanks[arc.source])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ContractionHierarchy::unpack(uint32_t arcIndex, bool fromSource, std::vector<Step> &steps) const
+{
+    const Arc &arc = mArcs[arcIndex];
+
+    if(arc.edge != INVALID_INDEX)
+    {
+        if(fromSource)
+        {
+            steps.push_back({arc.source, arc.target, arc.edge, arc.reversed != 0});
+        }
+        else
+        {
+            steps.push_back({arc.target, arc.source, arc.edge, arc.reversed == 0});
+        }
+        return;
+    }
+
+    // Children run middle -> source and middle -> target
+    if(fromSource)
+    {
+        unpack(arc.sourceChild, false, steps);
+        unpack(arc.targetChild, true, steps);
+    }
+    else
+    {
+        unpack(arc.targetChild, false, steps);
+        unpack(arc.sourceChild, true, steps);
+    }
+}
+
+bool ContractionHierarchy::query(SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const
+{
+    const CsrGraph::Overlay &overlay = context.getOverlay();
+    const uint32_t nodeCount = getNodeCount();
+
+    SearchContext &backward = context.getBackwardContext();
+    context.startSearch(overlay.getNodeCount());
+    backward.startSearch(overlay.getNodeCount());
+
+    using QueueItem = std::pair<double, uint32_t>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+    Queue forwardQueue;
+    Queue backwardQueue;
+
+    double bestCost = std::numeric_limits<double>::infinity();
+    uint32_t meetingIndex = INVALID_INDEX;
+    std::vector<Step> steps;
+
+    // Phantom nodes enter the hierarchy through the ends of their edge; their labels keep the graph edge instead of an arc
+    auto seed = [&](uint32_t node, SearchContext &labels, Queue &queue)
+    {
+        if(node < nodeCount)
+        {
+            labels.setLabel(node, 0.0, INVALID_INDEX, INVALID_INDEX, false);
+            queue.emplace(0.0, node);
+            return;
+        }
+
+        for(const auto &overlayArc : overlay.arcs)
+        {
+            if(overlayArc.source != node || overlayArc.arc.target >= nodeCount) continue;
+
+            const double cost = mEdgeCosts[overlayArc.arc.edge] * overlayArc.weightFactor;
+            if(cost < labels.getCost(overlayArc.arc.target))
+            {
+                labels.setLabel(overlayArc.arc.target, cost, node, overlayArc.arc.edge, overlayArc.arc.reversed);
+                queue.emplace(cost, overlayArc.arc.target);
+            }
+        }
+    };
+
+    if(startIndex == goalIndex)
+    {
+        bestCost = 0;
+    }
+    else
+    {
+        seed(startIndex, context, forwardQueue);
+        seed(goalIndex, backward, backwardQueue);
+
+        // Both phantom nodes on the same edge
+        for(const auto &overlayArc : overlay.arcs)
+        {
+            if(overlayArc.source == startIndex && overlayArc.arc.target == goalIndex)
+            {
+                const double cost = mEdgeCosts[overlayArc.arc.edge] * overlayArc.weightFactor;
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    steps = {{startIndex, goalIndex, overlayArc.arc.edge, overlayArc.arc.reversed != 0}};
+                }
+            }
+        }
+    }
+
+    auto expand = [&](Queue &queue, SearchContext &labels, const SearchContext &otherLabels)
+    {
+        auto [cost, node] = queue.top();
+        queue.pop();
+
+        if(labels.isSettled(node) || cost > labels.getCost(node)) return;
+        labels.settle(node);
+
+        if(otherLabels.isReached(node) && cost + otherLabels.getCost(node) < bestCost)
+        {
+            bestCost = cost + otherLabels.getCost(node);
+            meetingIndex = node;
+        }
+
+        for(uint32_t arcIndex = mOffsets[node]; arcIndex < mOffsets[node + 1]; arcIndex++)
+        {
+            const Arc &arc = mArcs[arcIndex];
+            const double newCost = cost + arc.cost;
+            if(newCost < labels.getCost(arc.target))
+            {
+                labels.setLabel(arc.target, newCost, node, arcIndex, false);
+                queue.emplace(newCost, arc.target);
+            }
+        }
+    };
+
+    // Upward searches from both sides; each side stops once its smallest key cannot improve the best meeting
+    while(true)
+    {
+        const bool forwardDone = forwardQueue.empty() || forwardQueue.top().first >= bestCost;
+        const bool backwardDone = backwardQueue.empty() || backwardQueue.top().first >= bestCost;
+        if(forwardDone && backwardDone) break;
+
+        if(!forwardDone && (backwardDone || forwardQueue.top().first <= backwardQueue.top().first))
+        {
+            expand(forwardQueue, context, backward);
+        }
+        else
+        {
+            expand(backwardQueue, backward, context);
+        }
+    }
+
+    if(std::isinf(bestCost))
+    {
+        return false;
+    }
+
+    if(meetingIndex != INVALID_INDEX)
+    {
+        steps.clear();
+
+        // Forward half: collected from the meeting node down to the start, then reversed
+        std::vector<Step> forwardSteps;
+        for(uint32_t node = meetingIndex; node != startIndex;)
+        {
+            const uint32_t parent = context.getParent(node);
+            if(parent >= nodeCount)
+            {
+                forwardSteps.push_back({parent, node, context.getParentEdge(node), context.isParentEdgeReversed(node)});
+            }
+            else
+            {
+                std::vector<Step> arcSteps;
+                unpack(context.getParentEdge(node), true, arcSteps);
+                forwardSteps.insert(forwardSteps.end(), arcSteps.rbegin(), arcSteps.rend());
+            }
+            node = parent;
+        }
+        steps.assign(forwardSteps.rbegin(), forwardSteps.rend());
+
+        // Backward half: from the meeting node towards the goal
+        for(uint32_t node = meetingIndex; node != goalIndex;)
+        {
+            const uint32_t parent = backward.getParent(node);
+            if(parent >= nodeCount)
+            {
+                steps.push_back({node, parent, backward.getParentEdge(node), !backward.isParentEdgeReversed(node)});
+            }
+            else
+            {
+                unpack(backward.getParentEdge(node), false, steps);
+            }
+            node = parent;
+        }
+    }
+
+    // Leave the path in the forward labels, like a unidirectional search
+    context.startSearch(overlay.getNodeCount());
+    context.setLabel(startIndex, 0.0, INVALID_INDEX, INVALID_INDEX, false);
+
+    double cost = 0;
+    for(const Step &step : steps)
+    {
+        double weightFactor = 1.0;
+        if(step.from >= nodeCount || step.to >= nodeCount)
+        {
+            for(const auto &overlayArc : overlay.arcs)
+            {
+                if(overlayArc.source == step.from && overlayArc.arc.target == step.to) weightFactor = overlayArc.weightFactor;
+            }
+        }
+        cost += mEdgeCosts[step.edge] * weightFactor;
+        context.setLabel(step.to, cost, step.from, step.edge, step.reversed);
+    }
+
+    return true;
+}
@@ -12,12 +12,15 @@ std::ostream &operator<<(std::ostream &os, const Coordinates &coords)
 Coordinates::Coordinates(const std::string &coordString)
 {
     std::stringstream ss(coordString);
+    double latitude, longitude;
     char comma;
     
     // read: Double -> Char -> Double
     // >> automatically skips whitespace, so "lat, lon" and "lat ,lon" or "lat,lon" are all valid
-    if (!(ss >> mLatitude >> comma >> mLongitude) || comma != ',')
+    if (!(ss >> latitude >> comma >> longitude) || comma != ',')
     {
         throw std::invalid_argument("Ungueltiges Format. Erwartet: 'lat, lon'");
     }
+    mLatitude = toFixedPoint(latitude);
+    mLongitude = toFixedPoint(longitude);
 }
@@ -0,0 +1,113 @@
+#include "csrgraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "library.hpp"
+
+CsrGraph::CsrGraph(const Graph &graph)
+{
+    if(!graph.getSplitItemIds().empty())
+    {
+        throw std::logic_error("CSR graph must be built before split items are added");
+    }
+
+    if(graph.getEdgeCount() >= (1u << 31))
+    {
+        throw std::runtime_error("Too many edges for CSR graph: " + std::to_string(graph.getEdgeCount()));
+    }
+
+    mEdgeCount = graph.getEdgeCount();
+
+    mCoordinates.reserve(graph.getNodeCount());
+    for(uint32_t index = 0; index < graph.getNodeCount(); index++)
+    {
+        mCoordinates.push_back(graph.getNodeByIndex(index)->getCoordinates());
+    }
+
+    mOffsets.assign(graph.getNodeCount() + 1, 0);
+    for(uint32_t edgeIndex = 0; edgeIndex < mEdgeCount; edgeIndex++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        mOffsets[edge->from()->getIndex() + 1]++;
+        mOffsets[edge->to()->getIndex() + 1]++;
+    }
+
+    for(size_t index = 1; index < mOffsets.size(); index++)
+    {
+        mOffsets[index] += mOffsets[index - 1];
+    }
+
+    mArcs.resize(mOffsets.back());
+    std::vector<uint32_t> fill(mOffsets.begin(), mOffsets.end() - 1);
+    for(uint32_t edgeIndex = 0; edgeIndex < mEdgeCount; edgeIndex++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        const uint32_t from = edge->from()->getIndex();
+        const uint32_t to = edge->to()->getIndex();
+
+        mArcs[fill[from]++] = Arc{to, edgeIndex, 0};
+        mArcs[fill[to]++] = Arc{from, edgeIndex, 1};
+    }
+}
+
+void CsrGraph::buildOverlay(const Graph &graph, Overlay &overlay) const
+{
+    overlay.clear();
+    overlay.phantomBase = graph.getNodeCount();
+
+    for(uint32_t edgeIndex = getEdgeCount(); edgeIndex < graph.getEdgeCount(); edgeIndex++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        if(edge == nullptr || !edge->from() || !edge->to()) continue;
+
+        const uint32_t from = edge->from()->getIndex();
+        const uint32_t to = edge->to()->getIndex();
+
+        overlay.addArc(from, Arc{to, edgeIndex, 0}, 1.0);
+        overlay.addArc(to, Arc{from, edgeIndex, 1}, 1.0);
+    }
+}
+
+uint32_t CsrGraph::addPhantomNode(const Graph &graph, Overlay &overlay, const Coordinates &point, uint32_t edgeIndex, uint8_t segmentIndex) const
+{
+    const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+    const auto &path = edge->getPath();
+
+    // Same length split as Graph::addSplit
+    const Coordinates projection = HelperFunctions::getProjectionOnSegment(point, path[segmentIndex], path[segmentIndex + 1]);
+    double lengthToPoint = HelperFunctions::haversine(path[segmentIndex], projection);
+    for(size_t pathIndex = 0; pathIndex < segmentIndex; pathIndex++)
+    {
+        lengthToPoint += HelperFunctions::haversine(path[pathIndex], path[pathIndex + 1]);
+    }
+    const double wayLength = edge->calculateWayLength();
+    const double fraction = wayLength > 0 ? std::clamp(lengthToPoint / wayLength, 0.0, 1.0) : 0.0;
+
+    const uint32_t phantom = overlay.getNodeCount();
+    const uint32_t from = edge->from()->getIndex();
+    const uint32_t to = edge->to()->getIndex();
+
+    overlay.addArc(phantom, Arc{from, edgeIndex, 1}, fraction);
+    overlay.addArc(phantom, Arc{to, edgeIndex, 0}, 1.0 - fraction);
+    overlay.addArc(from, Arc{phantom, edgeIndex, 0}, fraction);
+    overlay.addArc(to, Arc{phantom, edgeIndex, 1}, 1.0 - fraction);
+
+    // Phantom nodes on the same edge are connected directly
+    for(uint32_t other = overlay.phantomBase; other < phantom; other++)
+    {
+        const Overlay::PhantomNode &otherNode = overlay.getPhantomNode(other);
+        if(otherNode.edge != edgeIndex) continue;
+
+        const bool forward = otherNode.fraction <= fraction;
+        const double weightFactor = std::abs(fraction - otherNode.fraction);
+        overlay.addArc(other, Arc{phantom, edgeIndex, forward ? 0u : 1u}, weightFactor);
+        overlay.addArc(phantom, Arc{other, edgeIndex, forward ? 1u : 0u}, weightFactor);
+    }
+
+    overlay.phantomNodes.push_back({projection, edgeIndex, segmentIndex, fraction});
+
+    return phantom;
+}
@@ -0,0 +1,337 @@
+#include "customizablecontractionhierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "graph.hpp"
+#include "weights.hpp"
+
+namespace
+{
+    // Cells up to this size are not dissected further
+    constexpr size_t MIN_CELL_SIZE = 12;
+
+    // Levels smaller than this are customized on the calling thread
+    constexpr size_t MIN_PARALLEL_LEVEL_SIZE = 1024;
+
+    // Calls function(index) for all indices in [begin, end), split into contiguous chunks over threadCount threads
+    template <typename Function>
+    void parallelFor(size_t begin, size_t end, unsigned threadCount, Function &&function)
+    {
+        if(threadCount <= 1 || end - begin < MIN_PARALLEL_LEVEL_SIZE)
+        {
+            for(size_t i = begin; i < end; i++) function(i);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        const size_t chunkSize = (end - begin + threadCount - 1) / threadCount;
+        for(size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize)
+        {
+            const size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+            threads.emplace_back([&function, chunkBegin, chunkEnd]()
+            {
+                for(size_t i = chunkBegin; i < chunkEnd; i++) function(i);
+            });
+        }
+        for(auto &thread : threads) thread.join();
+    }
+
+    // Geometric nested dissection: splits a cell at the median of its wider extent and orders the nodes of the
+    // smaller boundary as separator after both halves. Appends the cell's nodes to order, lowest rank first.
+    void dissect(const CsrGraph &csrGraph, std::vector<uint32_t> cell, std::vector<uint8_t> &sides, std::vector<uint32_t> &order)
+    {
+        if(cell.size() <= MIN_CELL_SIZE)
+        {
+            order.insert(order.end(), cell.begin(), cell.end());
+            return;
+        }
+
+        double minLatitude = std::numeric_limits<double>::infinity(), maxLatitude = -minLatitude;
+        double minLongitude = minLatitude, maxLongitude = -minLatitude;
+        for(uint32_t node : cell)
+        {
+            const Coordinates &coordinates = csrGraph.getCoordinates(node);
+            minLatitude = std::min(minLatitude, coordinates.getLatitude());
+            maxLatitude = std::max(maxLatitude, coordinates.getLatitude());
+            minLongitude = std::min(minLongitude, coordinates.getLongitude());
+            maxLongitude = std::max(maxLongitude, coordinates.getLongitude());
+        }
+
+        const double longitudeScale = std::cos((minLatitude + maxLatitude) / 2.0 * M_PI / 180.0);
+        const bool splitLatitude = maxLatitude - minLatitude >= (maxLongitude - minLongitude) * longitudeScale;
+        auto key = [&](uint32_t node)
+        {
+            const Coordinates &coordinates = csrGraph.getCoordinates(node);
+            return splitLatitude ? coordinates.getLatitude() : coordinates.getLongitude();
+        };
+
+        const auto middle = cell.begin() + cell.size() / 2;
+        std::nth_element(cell.begin(), middle, cell.end(), [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+
+        for(auto it = cell.begin(); it != cell.end(); ++it)
+        {
+            sides[*it] = it < middle ? 1 : 2;
+        }
+
+        // Boundary nodes of both halves; the smaller one becomes the separator
+        std::vector<uint32_t> boundaries[2];
+        for(uint32_t node : cell)
+        {
+            for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+            {
+                if(sides[arc.target] != 0 && sides[arc.target] != sides[node])
+                {
+                    boundaries[sides[node] - 1].push_back(node);
+                    break;
+                }
+            }
+        }
+        const uint8_t separatorSide = boundaries[0].size() <= boundaries[1].size() ? 1 : 2;
+        std::vector<uint32_t> &separator = boundaries[separatorSide - 1];
+
+        for(uint32_t node : separator) sides[node] = 3;
+
+        std::vector<uint32_t> halves[2];
+        for(uint32_t node : cell)
+        {
+            if(sides[node] != 3) halves[sides[node] - 1].push_back(node);
+        }
+        for(uint32_t node : cell) sides[node] = 0;
+
+        std::vector<uint32_t>().swap(cell);
+        dissect(csrGraph, std::move(halves[0]), sides, order);
+        dissect(csrGraph, std::move(halves[1]), sides, order);
+        order.insert(order.end(), separator.begin(), separator.end());
+    }
+}
+
+CustomizableContractionHierarchy::CustomizableContractionHierarchy(const CsrGraph &csrGraph)
+{
+    computeOrder(csrGraph);
+    buildTopology(csrGraph);
+}
+
+void CustomizableContractionHierarchy::computeOrder(const CsrGraph &csrGraph)
+{
+    const uint32_t nodeCount = csrGraph.getNodeCount();
+
+    std::vector<uint32_t> cell(nodeCount);
+    for(uint32_t node = 0; node < nodeCount; node++) cell[node] = node;
+
+    std::vector<uint8_t> sides(nodeCount, 0);
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+    dissect(csrGraph, std::move(cell), sides, order);
+
+    mRanks.resize(nodeCount);
+    for(uint32_t rank = 0; rank < nodeCount; rank++)
+    {
+        mRanks[order[rank]] = rank;
+    }
+}
+
+void CustomizableContractionHierarchy::buildTopology(const CsrGraph &csrGraph)
+{
+    const uint32_t nodeCount = csrGraph.getNodeCount();
+
+    std::vector<uint32_t> order(nodeCount);
+    for(uint32_t node = 0; node < nodeCount; node++) order[mRanks[node]] = node;
+
+    // Upward neighbors of the chordal supergraph: contracting a node connects all its upper neighbors,
+    // which is equivalent to merging them into the lowest one (the node's parent in the elimination tree)
+    std::vector<std::vector<uint32_t>> upward(nodeCount);
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+        {
+            if(mRanks[arc.target] > mRanks[node]) upward[node].push_back(arc.target);
+        }
+    }
+
+    auto byRank = [this](uint32_t a, uint32_t b) { return mRanks[a] < mRanks[b]; };
+    for(uint32_t node : order)
+    {
+        auto &neighbors = upward[node];
+        std::sort(neighbors.begin(), neighbors.end(), byRank);
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        if(neighbors.size() > 1)
+        {
+            auto &parentNeighbors = upward[neighbors.front()];
+            parentNeighbors.insert(parentNeighbors.end(), neighbors.begin() + 1, neighbors.end());
+        }
+    }
+
+    mOffsets.assign(nodeCount + 1, 0);
+    mTargets.clear();
+    mSources.clear();
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        auto &neighbors = upward[node];
+        std::sort(neighbors.begin(), neighbors.end());
+        mTargets.insert(mTargets.end(), neighbors.begin(), neighbors.end());
+        mSources.insert(mSources.end(), neighbors.size(), node);
+        mOffsets[node + 1] = static_cast<uint32_t>(mTargets.size());
+        std::vector<uint32_t>().swap(neighbors);
+    }
+
+    // Original edges per arc
+    std::vector<std::pair<uint32_t, EdgeRef>> edgeRefs;
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+        {
+            if(arc.reversed || arc.target == node) continue;
+
+            if(mRanks[node] < mRanks[arc.target])
+            {
+                edgeRefs.push_back({findArc(node, arc.target), {arc.edge, 0}});
+            }
+            else
+            {
+                edgeRefs.push_back({findArc(arc.target, node), {arc.edge, 1}});
+            }
+        }
+    }
+    std::sort(edgeRefs.begin(), edgeRefs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    mEdgeOffsets.assign(mTargets.size() + 1, 0);
+    mEdges.clear();
+    for(const auto &[arc, edgeRef] : edgeRefs)
+    {
+        mEdgeOffsets[arc + 1]++;
+        mEdges.push_back(edgeRef);
+    }
+    for(size_t arc = 0; arc < mTargets.size(); arc++) mEdgeOffsets[arc + 1] += mEdgeOffsets[arc];
+
+    // Lower triangles: every pair of upward arcs of a node closes a triangle with the arc between their targets
+    mTriangleOffsets.assign(mTargets.size() + 1, 0);
+    auto forEachTriangle = [this](auto &&visitor)
+    {
+        for(uint32_t node = 0; node < getNodeCount(); node++)
+        {
+            for(uint32_t first = mOffsets[node]; first < mOffsets[node + 1]; first++)
+            {
+                for(uint32_t second = first + 1; second < mOffsets[node + 1]; second++)
+                {
+                    if(mRanks[mTargets[first]] < mRanks[mTargets[second]])
+                    {
+                        visitor(findArc(mTargets[first], mTargets[second]), Triangle{first, second});
+                    }
+                    else
+                    {
+                        visitor(findArc(mTargets[second], mTargets[first]), Triangle{second, first});
+                    }
+                }
+            }
+        }
+    };
+
+    forEachTriangle([this](uint32_t arc, const Triangle &) { mTriangleOffsets[arc + 1]++; });
+    for(size_t arc = 0; arc < mTargets.size(); arc++) mTriangleOffsets[arc + 1] += mTriangleOffsets[arc];
+
+    mTriangles.resize(mTriangleOffsets.back());
+    std::vector<uint32_t> fill(mTriangleOffsets.begin(), mTriangleOffsets.end() - 1);
+    forEachTriangle([this, &fill](uint32_t arc, const Triangle &triangle) { mTriangles[fill[arc]++] = triangle; });
+
+    // A node's arcs depend on the arcs of its lower neighbors, so its level is one above theirs
+    std::vector<uint32_t> levels(nodeCount, 0);
+    uint32_t levelCount = nodeCount > 0 ? 1 : 0;
+    for(uint32_t node : order)
+    {
+        for(uint32_t arc = mOffsets[node]; arc < mOffsets[node + 1]; arc++)
+        {
+            levels[mTargets[arc]] = std::max(levels[mTargets[arc]], levels[node] + 1);
+            levelCount = std::max(levelCount, levels[mTargets[arc]] + 1);
+        }
+    }
+
+    mLevelOffsets.assign(levelCount + 1, 0);
+    for(uint32_t node = 0; node < nodeCount; node++) mLevelOffsets[levels[node] + 1]++;
+    for(uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+
+    mLevelNodes.resize(nodeCount);
+    fill.assign(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+    for(uint32_t node = 0; node < nodeCount; node++) mLevelNodes[fill[levels[node]]++] = node;
+}
+
+uint32_t CustomizableContractionHierarchy::findArc(uint32_t source, uint32_t target) const
+{
+    const auto begin = mTargets.begin() + mOffsets[source];
+    const auto end = mTargets.begin() + mOffsets[source + 1];
+    const auto it = std::lower_bound(begin, end, target);
+    return it != end && *it == target ? static_cast<uint32_t>(it - mTargets.begin()) : ContractionHierarchy::INVALID_INDEX;
+}
+
+std::unique_ptr<ContractionHierarchy> CustomizableContractionHierarchy::customize(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights, unsigned threadCount) const
+{
+    if(threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::unique_ptr<ContractionHierarchy> hierarchy(new ContractionHierarchy());
+    hierarchy->mWeighted = weights != nullptr;
+    hierarchy->mRanks = mRanks;
+    hierarchy->mOffsets = mOffsets;
+
+    // Edge costs; Weights lookups dominate here, so they are spread over the threads as well
+    std::vector<double> &edgeCosts = hierarchy->mEdgeCosts;
+    edgeCosts.resize(csrGraph.getEdgeCount());
+    parallelFor(0, edgeCosts.size(), threadCount, [&](size_t edgeIndex)
+    {
+        const Edge *edge = graph.getEdgeByIndex(static_cast<uint32_t>(edgeIndex));
+        edgeCosts[edgeIndex] = edge->getWeight() + edge->getWeight() * (weights ? weights->getWeight(edge->getParameters()) : 0.0);
+    });
+
+    // Arcs start with their cheapest original edge
+    std::vector<ContractionHierarchy::Arc> &arcs = hierarchy->mArcs;
+    arcs.resize(mTargets.size());
+    parallelFor(0, arcs.size(), threadCount, [&](size_t arcIndex)
+    {
+        ContractionHierarchy::Arc &arc = arcs[arcIndex];
+        arc = {mSources[arcIndex], mTargets[arcIndex], std::numeric_limits<double>::infinity(), ContractionHierarchy::INVALID_INDEX, 0, ContractionHierarchy::INVALID_INDEX, ContractionHierarchy::INVALID_INDEX};
+
+        for(uint32_t i = mEdgeOffsets[arcIndex]; i < mEdgeOffsets[arcIndex + 1]; i++)
+        {
+            if(edgeCosts[mEdges[i].edge] < arc.cost)
+            {
+                arc.cost = edgeCosts[mEdges[i].edge];
+                arc.edge = mEdges[i].edge;
+                arc.reversed = mEdges[i].reversed;
+            }
+        }
+    });
+
+    // Basic customization: relax every arc over its lower triangles, level by level
+    for(size_t level = 0; level + 1 < mLevelOffsets.size(); level++)
+    {
+        parallelFor(mLevelOffsets[level], mLevelOffsets[level + 1], threadCount, [&](size_t i)
+        {
+            const uint32_t node = mLevelNodes[i];
+            for(uint32_t arcIndex = mOffsets[node]; arcIndex < mOffsets[node + 1]; arcIndex++)
+            {
+                ContractionHierarchy::Arc &arc = arcs[arcIndex];
+                for(uint32_t t = mTriangleOffsets[arcIndex]; t < mTriangleOffsets[arcIndex + 1]; t++)
+                {
+                    const Triangle &triangle = mTriangles[t];
+                    const double cost = arcs[triangle.sourceArc].cost + arcs[triangle.targetArc].cost;
+                    if(cost < arc.cost)
+                    {
+                        arc.cost = cost;
+                        arc.edge = ContractionHierarchy::INVALID_INDEX;
+                        arc.reversed = 0;
+                        arc.sourceChild = triangle.sourceArc;
+                        arc.targetChild = triangle.targetArc;
+                    }
+                }
+            }
+        });
+    }
+
+    hierarchy->mCostHash = ContractionHierarchy::hashCosts(csrGraph, edgeCosts);
+    return hierarchy;
+}
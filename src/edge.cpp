@@ -5,16 +5,18 @@
 
 #include "library.hpp"
 
-Edge::Edge(uint64_t id, double waylength, std::shared_ptr<Node> from, std::shared_ptr<Node> to, std::vector<Coordinates> path)  : mId(id), mWaylength(waylength), mNodes{from, to}, mPath(std::move(path))
+Edge::Edge(uint64_t id, double waylength, std::shared_ptr<Node> from, std::shared_ptr<Node> to, const std::vector<Coordinates> &geometry, uint32_t pathOffset, uint32_t pathSize)
+    : mId(id), mWaylength(waylength), mNodes{from, to}, mGeometry(&geometry), mPathOffset(pathOffset), mPathSize(pathSize)
 {
 }
 
 double Edge::calculateWayLength() const
 {
+    const std::span<const Coordinates> path = getPath();
     double waylength = 0;
-    for(uint8_t i = 0; i < mPath.size() - 1; i++)
+    for(uint8_t i = 0; i < path.size() - 1; i++)
     {
-        waylength += HelperFunctions::haversine(mPath[i], mPath[i + 1]);
+        waylength += HelperFunctions::haversine(path[i], path[i + 1]);
     }
 
     return waylength;
@@ -6,7 +6,7 @@
 #include <algorithm>
 
 #include "library.hpp"
-#include "quadtree.hpp"
+#include "packedrtree.hpp"
 #include "graph.hpp"
 
 GPXParser::GPXParser()
@@ -37,24 +37,24 @@ std::vector<std::tuple<uint64_t, Coordinates>> GPXParser::mapMatching(Router &ro
     std::vector<Coordinates> routingPoints;
     resetRoutingPoints();
 
+    // The two nearest edges only depend on the geometry, so all track points are looked up at once
+    const ClosestEdgesBatch closestEdgesBatch = router.getRTree().getClosestEdgesBatch(trackPoints, 2, false);
+
     routingPoints.emplace_back(trackPoints[0]);
     for(uint16_t i = 1; i < trackPoints.size() - 1; i++)
     {
-        auto closestEdges = router.getQuadtree().getClosestEdges(trackPoints[i], 3, false);
+        const std::span<const ClosestEdges> closestEdges = closestEdgesBatch.getClosestEdges(i);
         closestEdges[0].edge->bestSnapPointCounter++;
 
-        for(const auto &edge : closestEdges)
+        for(const auto &edge : router.getRTree().withinRadius(trackPoints[i], SNAP_RADIUS, false))
         {
-            if(edge.distance < 20)
-            {
-                mEdges.insert(edge.edge);
+            mEdges.insert(edge.edge);
 
-                double pathLength = edge.edge->calculateWayLength();
-                double newWeight = (pathLength * (edge.distance + 1)) / NO_EDGE_SNAP_PENALTY;
-                
-                edge.edge->setWeight((edge.edge->getWeight() * edge.edge->snapPointCounter + newWeight) / (edge.edge->snapPointCounter + 1));
-                edge.edge->snapPointCounter++;
-            }
+            double pathLength = edge.edge->calculateWayLength();
+            double newWeight = (pathLength * (edge.distance + 1)) / NO_EDGE_SNAP_PENALTY;
+
+            edge.edge->setWeight((edge.edge->getWeight() * edge.edge->snapPointCounter + newWeight) / (edge.edge->snapPointCounter + 1));
+            edge.edge->snapPointCounter++;
         }
 
         if(checkRoutingTrackPoints(closestEdges, routingPoints, i, trackPoints[i]))
@@ -68,7 +68,7 @@ std::vector<std::tuple<uint64_t, Coordinates>> GPXParser::mapMatching(Router &ro
             }
             else
             {
-                reset();
+                reset(router);
             }
 
             // MIN_ROUTING_LENGTH points can be skipped, but only to the current index (so all points will be checked at least once)
@@ -81,7 +81,7 @@ std::vector<std::tuple<uint64_t, Coordinates>> GPXParser::mapMatching(Router &ro
 
     calculateSnapPenalties();
     doRouting(routingPoints[routingPoints.size() - 2], routingPoints[routingPoints.size() - 1], router, projections);
-    reset();
+    reset(router);
 
     return projections;
 }
@@ -103,6 +103,12 @@ void GPXParser::calculateSnapPenalties()
 
 bool GPXParser::doRouting(const Coordinates &start, const Coordinates &end, Router &router, std::vector<std::tuple<uint64_t, Coordinates>> &pathContainer) const
 {
+    // The snap penalties changed edge lengths the router has compiled into its profiles
+    for(const auto &edge : mEdges)
+    {
+        router.updateEdgeCost(*edge);
+    }
+
     auto path = router.aStar(start, end, 1, true);
     pathContainer.insert(pathContainer.end(), path.begin(), path.end());
 
@@ -123,7 +129,7 @@ void GPXParser::parseGPXFile(const std::filesystem::directory_entry &file)
     }
 }
 
-bool GPXParser::checkRoutingTrackPoints(const std::vector<ClosestEdges> &edges, std::vector<Coordinates> &routingTrackPoints, uint16_t pointIndex, const Coordinates &coordinates)
+bool GPXParser::checkRoutingTrackPoints(std::span<const ClosestEdges> edges, std::vector<Coordinates> &routingTrackPoints, uint16_t pointIndex, const Coordinates &coordinates)
 {
     if((pointIndex - lastPointIndex) < MIN_ROUTING_LENGTH) return false;
 
@@ -159,11 +165,12 @@ void GPXParser::resetRoutingPoints()
     lastPointIndex = 0;
 }
 
-void GPXParser::reset()
+void GPXParser::reset(Router &router)
 {
     for(const auto &edge : mEdges)
     {
         edge->setWeight(edge->calculateWayLength());
+        router.updateEdgeCost(*edge);
         edge->snapPointCounter = 0;
         edge->bestSnapPointCounter = 0;
     }
@@ -8,6 +8,7 @@
 #include <memory>
 #include <tuple>
 #include <algorithm>
+#include <stdexcept>
 
 #include "library.hpp"
 #include "edge.hpp"
@@ -16,7 +17,12 @@ void Graph::addOsmNode(std::shared_ptr<OsmNode> node)
 {
     if(node->isEdge)
     {
-        mNodes.emplace(node->getId(), std::make_shared<Node>(*node));
+        auto [it, inserted] = mNodes.emplace(node->getId(), std::make_shared<Node>(*node));
+        if(inserted)
+        {
+            it->second->setIndex(getNodeCount());
+            mNodesByIndex.push_back(it->second.get());
+        }
     }
 }
 
@@ -46,20 +52,65 @@ void Graph::addOsmWay(const OsmWay *way)
             // First sub-way gets to keep original ID; subsequent IDs use 8 bits for sub-way index, 56 bits for way ID are copied
             uint64_t wayId = way->getId() | (subWayId++ << 56);
 
-            mEdges.emplace(wayId, std::make_shared<Edge>(wayId, waylength, fromNode, toNode, path));
-            mEdges.at(wayId)->setParameters(way->getParameters());
-            fromNode->edges.push_back(mEdges.at(wayId));
-            toNode->edges.push_back(mEdges.at(wayId));
+            addEdge(wayId, waylength, fromNode->getIndex(), toNode->getIndex(), path, way->getParameters());
 
             startIndex = index;
         }
     }
 }
 
+Node *Graph::addNode(uint64_t nodeId, const Coordinates &coordinates)
+{
+    auto [it, inserted] = mNodes.emplace(nodeId, std::make_shared<Node>(OsmNode(nodeId, coordinates.getLatitude(), coordinates.getLongitude())));
+    if(inserted)
+    {
+        it->second->setIndex(getNodeCount());
+        mNodesByIndex.push_back(it->second.get());
+    }
+    return it->second.get();
+}
+
+uint32_t Graph::addGeometry(std::span<const Coordinates> path)
+{
+    if(mGeometry.size() + path.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too many polyline points for the geometry pool");
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(mGeometry.size());
+    mGeometry.insert(mGeometry.end(), path.begin(), path.end());
+    return offset;
+}
+
+Edge *Graph::addEdge(uint64_t edgeId, double waylength, uint32_t fromIndex, uint32_t toIndex, std::span<const Coordinates> path, const Parameters &parameters)
+{
+    std::shared_ptr<Node> fromNode = mNodes.at(mNodesByIndex[fromIndex]->getId());
+    std::shared_ptr<Node> toNode = mNodes.at(mNodesByIndex[toIndex]->getId());
+
+    const uint32_t pathOffset = addGeometry(path);
+    auto edge = std::make_shared<Edge>(edgeId, waylength, fromNode, toNode, mGeometry, pathOffset, static_cast<uint32_t>(path.size()));
+    edge->setParameters(parameters);
+    edge->setIndex(getEdgeCount());
+
+    mEdges.emplace(edgeId, edge);
+    mEdgesByIndex.push_back(edge.get());
+    fromNode->edges.push_back(edge);
+    toNode->edges.push_back(edge);
+
+    return edge.get();
+}
+
 uint64_t Graph::addSplit(Coordinates closestCoords, uint64_t edgeId, uint8_t segmentIndex)
 {
     const auto edge = mEdges.at(edgeId);
-    const auto &path = edge->getPath();
+    // Both halves are built before the pool grows, which would invalidate the span
+    const std::span<const Coordinates> path = edge->getPath();
+
+    // The first split item marks where its geometry starts in the pool
+    if(mSplitItemIds.empty())
+    {
+        mSplitGeometryOffset = mGeometry.size();
+    }
 
     // Create new node at closest point
     uint64_t newNodeId = (uint64_t) - ++mSplitItemCount; // Generate unique ID for the new node
@@ -67,33 +118,41 @@ uint64_t Graph::addSplit(Coordinates closestCoords, uint64_t edgeId, uint8_t seg
 
     mNodes.emplace(newNodeId, newNode);
     mSplitItemIds.push_back(newNodeId);
+    newNode->setIndex(getNodeCount());
+    mNodesByIndex.push_back(newNode.get());
 
 
     // Create two new edges by splitting the original polyline at the segment index
     std::vector<Coordinates> path1(path.begin(), path.begin() + segmentIndex + 1);
     path1.push_back(closestCoords);
+
+    std::vector<Coordinates> path2;
+    path2.push_back(closestCoords);
+    path2.insert(path2.end(), path.begin() + segmentIndex + 1, path.end());
+
     double waylength1percentage = HelperFunctions::calculatePathLength(path1) / edge->calculateWayLength();
     double waylength1 = waylength1percentage * edge->getWeight();
 
     uint64_t edgeId1 = edgeId | ((uint64_t)++mSplitItemCount << 60); // New sub-way ID
-    auto edge1 = std::make_shared<Edge>(edgeId1, waylength1, edge->from(), newNode, path1);
+    auto edge1 = std::make_shared<Edge>(edgeId1, waylength1, edge->from(), newNode, mGeometry, addGeometry(path1), static_cast<uint32_t>(path1.size()));
     mEdges.emplace(edgeId1, edge1);
     mSplitItemIds.push_back(edgeId1);
+    edge1->setIndex(getEdgeCount());
+    mEdgesByIndex.push_back(edge1.get());
 
     edge->from()->edges.push_back(edge1);
     newNode->edges.push_back(edge1);
 
 
-    std::vector<Coordinates> path2;
-    path2.push_back(closestCoords);
-    path2.insert(path2.end(), path.begin() + segmentIndex + 1, path.end());
     double waylength2percentage = 1 - waylength1percentage;
     double waylength2 = waylength2percentage * edge->getWeight();
 
     uint64_t edgeId2 = edgeId | ((uint64_t)++mSplitItemCount << 60); // New sub-way ID
-    auto edge2 = std::make_shared<Edge>(edgeId2, waylength2, newNode, edge->to(), path2);
+    auto edge2 = std::make_shared<Edge>(edgeId2, waylength2, newNode, edge->to(), mGeometry, addGeometry(path2), static_cast<uint32_t>(path2.size()));
     mEdges.emplace(edgeId2, edge2);
     mSplitItemIds.push_back(edgeId2);
+    edge2->setIndex(getEdgeCount());
+    mEdgesByIndex.push_back(edge2.get());
     
     newNode->edges.push_back(edge2);
     edge->to()->edges.push_back(edge2);
@@ -123,6 +182,7 @@ void Graph::removeSplitItems()
                 toEdges.erase(std::remove(toEdges.begin(), toEdges.end(), edge), toEdges.end());
             }
 
+            mEdgesByIndex[edge->getIndex()] = nullptr;
             mEdges.erase(edgeIt);
             continue;
         }
@@ -132,11 +192,20 @@ void Graph::removeSplitItems()
         if (nodeIt != mNodes.end())
         {
             nodeIt->second->edges.clear(); 
+            mNodesByIndex[nodeIt->second->getIndex()] = nullptr;
             
             mNodes.erase(nodeIt);
         }
     }
     
+    // Split items always occupy the last indices
+    while(!mNodesByIndex.empty() && mNodesByIndex.back() == nullptr) mNodesByIndex.pop_back();
+    while(!mEdgesByIndex.empty() && mEdgesByIndex.back() == nullptr) mEdgesByIndex.pop_back();
+    if(!mSplitItemIds.empty())
+    {
+        mGeometry.erase(mGeometry.begin() + mSplitGeometryOffset, mGeometry.end());
+    }
+
     mSplitItemIds.clear();
     mSplitItemCount = 0;
 }
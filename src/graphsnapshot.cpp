@@ -0,0 +1,344 @@
+#include "graphsnapshot.hpp"
+
+#include <ankerl/unordered_dense.h>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "packedrtree.hpp"
+
+namespace
+{
+    constexpr char FILE_MAGIC[4] = {'R', 'G', 'S', '1'};
+    constexpr uint32_t FILE_VERSION = 5;
+
+    constexpr size_t ALIGNMENT = 8;
+
+    size_t align(size_t size) { return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+}
+
+GraphSnapshot::GraphSnapshot(const std::string &filename) : mFile(filename)
+{
+    const size_t size = mFile.size();
+    auto fail = [&](const std::string &reason)
+    {
+        throw std::runtime_error("Invalid graph snapshot " + filename + ": " + reason);
+    };
+
+    if(size < sizeof(FileHeader) || std::memcmp(getHeader().magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+    {
+        fail("not a snapshot");
+    }
+    if(getHeader().version != FILE_VERSION)
+    {
+        fail("version " + std::to_string(getHeader().version) + ", expected " + std::to_string(FILE_VERSION));
+    }
+    if(getHeader().fileSize != size)
+    {
+        fail("truncated");
+    }
+
+    constexpr size_t recordSizes[SECTION_COUNT] = {sizeof(NodeRecord), sizeof(EdgeRecord), sizeof(PointRecord), sizeof(TagRecord),
+                                                   sizeof(uint32_t), sizeof(char), sizeof(BoxRecord), sizeof(BoxRecord), sizeof(uint32_t),
+                                                   sizeof(SegmentRecord), sizeof(uint32_t)};
+    for(uint32_t section = 0; section < SECTION_COUNT; section++)
+    {
+        const SectionEntry &entry = getHeader().sections[section];
+        if(entry.offset % ALIGNMENT != 0 || entry.offset > size || entry.count > (size - entry.offset) / recordSizes[section])
+        {
+            fail("section " + std::to_string(section) + " out of bounds");
+        }
+    }
+
+    if(checksum(mFile.data() + sizeof(FileHeader), size - sizeof(FileHeader)) != getHeader().checksum)
+    {
+        fail("checksum mismatch");
+    }
+
+    // The checksum only detects damage after writing; every index is checked once here so the loaders can trust the records
+    auto inRange = [](uint64_t offset, uint64_t count, size_t size) { return offset <= size && count <= size - offset; };
+
+    const std::span<const uint32_t> stringOffsets = getSection<uint32_t>(STRING_OFFSETS);
+    if(stringOffsets.empty() || stringOffsets.front() != 0)
+    {
+        fail("invalid string table");
+    }
+    for(size_t index = 1; index < stringOffsets.size(); index++)
+    {
+        if(stringOffsets[index] < stringOffsets[index - 1] || stringOffsets[index] > getSection<char>(STRINGS).size())
+        {
+            fail("invalid string table");
+        }
+    }
+    const size_t stringCount = stringOffsets.size() - 1;
+
+    for(const TagRecord &tag : getTags())
+    {
+        if(tag.key >= stringCount || tag.value >= stringCount)
+        {
+            fail("tag string out of range");
+        }
+    }
+
+    const std::span<const EdgeRecord> edges = getEdges();
+    for(const EdgeRecord &edge : edges)
+    {
+        if(edge.from >= getNodes().size() || edge.to >= getNodes().size())
+        {
+            fail("edge node out of range");
+        }
+        if(edge.geometryCount < 2 || !inRange(edge.geometryOffset, edge.geometryCount, getGeometry().size()))
+        {
+            fail("edge geometry out of range");
+        }
+        if(!inRange(edge.tagOffset, edge.tagCount, getTags().size()))
+        {
+            fail("edge tags out of range");
+        }
+    }
+
+    if(getSection<BoxRecord>(BOUNDARY).size() != 1)
+    {
+        fail("missing boundary");
+    }
+
+    // Level offsets must partition the boxes up to a single root, and every node must point to an aligned run of
+    // boxes in the level below, so the queries and the leaf slots of PackedRTree stay within the arrays
+    const std::span<const BoxRecord> boxes = getRTreeBoxes();
+    const std::span<const uint32_t> levelOffsets = getRTreeLevelOffsets();
+    const std::span<const SegmentRecord> segments = getRTreeSegments();
+    const std::span<const uint32_t> firstChildren = getRTreeFirstChildren();
+    if(levelOffsets.empty())
+    {
+        if(!boxes.empty() || !segments.empty() || !firstChildren.empty())
+        {
+            fail("invalid R-tree levels");
+        }
+    }
+    else
+    {
+        if(levelOffsets.size() < 3 || levelOffsets.front() != 0 || levelOffsets.back() != boxes.size()
+           || levelOffsets[levelOffsets.size() - 1] - levelOffsets[levelOffsets.size() - 2] != 1)
+        {
+            fail("invalid R-tree levels");
+        }
+        for(size_t level = 1; level < levelOffsets.size(); level++)
+        {
+            if(levelOffsets[level] <= levelOffsets[level - 1])
+            {
+                fail("invalid R-tree levels");
+            }
+        }
+        if(segments.size() != levelOffsets[1] || firstChildren.size() != boxes.size() - segments.size())
+        {
+            fail("invalid R-tree levels");
+        }
+        for(size_t level = 2; level < levelOffsets.size(); level++)
+        {
+            for(uint32_t box = levelOffsets[level - 1]; box < levelOffsets[level]; box++)
+            {
+                const uint32_t firstChild = firstChildren[box - segments.size()];
+                if(firstChild < levelOffsets[level - 2] || firstChild >= levelOffsets[level - 1]
+                   || (firstChild - levelOffsets[level - 2]) % PackedRTree::NODE_SIZE != 0)
+                {
+                    fail("R-tree child out of range");
+                }
+            }
+        }
+    }
+    for(const SegmentRecord &segment : segments)
+    {
+        if(segment.edge >= edges.size() || segment.subwayId > std::numeric_limits<uint8_t>::max() || segment.subwayId + 1 >= edges[segment.edge].geometryCount)
+        {
+            fail("R-tree segment out of range");
+        }
+    }
+}
+
+bool GraphSnapshot::isSnapshot(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(FILE_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+}
+
+uint64_t GraphSnapshot::checksum(const char *data, size_t size)
+{
+    // FNV-1a over 64-bit words; sections are padded to whole words
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t offset = 0; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string_view GraphSnapshot::getString(uint32_t index) const
+{
+    const std::span<const uint32_t> offsets = getSection<uint32_t>(STRING_OFFSETS);
+    const std::span<const char> strings = getSection<char>(STRINGS);
+    return {strings.data() + offsets[index], offsets[index + 1] - offsets[index]};
+}
+
+Box GraphSnapshot::getBoundary() const
+{
+    const BoxRecord &boundary = getSection<BoxRecord>(BOUNDARY)[0];
+    return Box(Coordinates::fromFixedPoint(boundary.minLatitude, boundary.minLongitude), Coordinates::fromFixedPoint(boundary.maxLatitude, boundary.maxLongitude));
+}
+
+void GraphSnapshot::createGraph(Graph &graph) const
+{
+    for(const NodeRecord &node : getNodes())
+    {
+        graph.addNode(node.id, Coordinates::fromFixedPoint(node.latitude, node.longitude));
+    }
+    // Edge node indices were validated against the record count, so duplicate IDs would leave them dangling
+    if(graph.getNodeCount() != getNodes().size())
+    {
+        throw std::runtime_error("Invalid graph snapshot: duplicate node IDs");
+    }
+
+    const std::span<const PointRecord> geometry = getGeometry();
+    const std::span<const TagRecord> tags = getTags();
+
+    // Snapshot string indices translated to dictionary IDs on first use
+    std::vector<uint32_t> stringIds(getSection<uint32_t>(STRING_OFFSETS).size(), TagDictionary::INVALID_ID);
+    auto intern = [&](uint32_t index)
+    {
+        if(stringIds[index] == TagDictionary::INVALID_ID)
+        {
+            stringIds[index] = TagDictionary::getInstance().intern(getString(index));
+        }
+        return stringIds[index];
+    };
+    graph.reserveGeometry(graph.getGeometrySize() + geometry.size());
+    std::vector<Coordinates> path;
+    for(const EdgeRecord &edge : getEdges())
+    {
+        path.clear();
+        for(uint32_t point = edge.geometryOffset; point < edge.geometryOffset + edge.geometryCount; point++)
+        {
+            path.push_back(Coordinates::fromFixedPoint(geometry[point].latitude, geometry[point].longitude));
+        }
+
+        std::vector<Tag> edgeTags;
+        edgeTags.reserve(edge.tagCount);
+        for(uint32_t tag = edge.tagOffset; tag < edge.tagOffset + edge.tagCount; tag++)
+        {
+            edgeTags.push_back({intern(tags[tag].key), intern(tags[tag].value)});
+        }
+
+        graph.addEdge(edge.id, edge.weight, edge.from, edge.to, path, Parameters(std::move(edgeTags)));
+    }
+}
+
+void GraphSnapshot::write(const std::string &filename, const Graph &graph, const PackedRTree &rtree, const Box &boundary)
+{
+    if(!graph.getSplitItemIds().empty())
+    {
+        throw std::logic_error("Graph snapshot must be written before split items are added");
+    }
+
+    std::vector<NodeRecord> nodes;
+    nodes.reserve(graph.getNodeCount());
+    for(uint32_t index = 0; index < graph.getNodeCount(); index++)
+    {
+        const Node *node = graph.getNodeByIndex(index);
+        nodes.push_back({node->getId(), node->getCoordinates().getFixedLatitude(), node->getCoordinates().getFixedLongitude()});
+    }
+
+    // Tag keys and values are interned into one string table
+    std::vector<uint32_t> stringOffsets{0};
+    std::vector<char> strings;
+    ankerl::unordered_dense::map<std::string_view, uint32_t> stringIndices;
+    auto intern = [&](std::string_view string)
+    {
+        auto [it, inserted] = stringIndices.emplace(string, static_cast<uint32_t>(stringOffsets.size() - 1));
+        if(inserted)
+        {
+            strings.insert(strings.end(), string.begin(), string.end());
+            stringOffsets.push_back(static_cast<uint32_t>(strings.size()));
+        }
+        return it->second;
+    };
+
+    std::vector<EdgeRecord> edges;
+    std::vector<PointRecord> geometry;
+    std::vector<TagRecord> tags;
+    edges.reserve(graph.getEdgeCount());
+    for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(index);
+        EdgeRecord record{edge->getId(), edge->getWeight(), edge->from()->getIndex(), edge->to()->getIndex(),
+                          static_cast<uint32_t>(geometry.size()), static_cast<uint32_t>(edge->getPath().size()),
+                          static_cast<uint32_t>(tags.size()), static_cast<uint32_t>(edge->getParameters().getTags().size())};
+
+        for(const Coordinates &point : edge->getPath())
+        {
+            geometry.push_back({point.getFixedLatitude(), point.getFixedLongitude()});
+        }
+        for(const auto &[key, value] : edge->getParameters().getParameters())
+        {
+            tags.push_back({intern(key), intern(value)});
+        }
+        edges.push_back(record);
+    }
+
+    const BoxRecord boundaryRecord{boundary.getMinLatitudeLongitude().getFixedLatitude(), boundary.getMinLatitudeLongitude().getFixedLongitude(),
+                                   boundary.getMaxLatitudeLongitude().getFixedLatitude(), boundary.getMaxLatitudeLongitude().getFixedLongitude()};
+
+    std::vector<BoxRecord> rtreeBoxes;
+    rtreeBoxes.reserve(rtree.mMinLatitudes.size());
+    for(size_t box = 0; box < rtree.mMinLatitudes.size(); box++)
+    {
+        rtreeBoxes.push_back({rtree.mMinLatitudes[box], rtree.mMinLongitudes[box], rtree.mMaxLatitudes[box], rtree.mMaxLongitudes[box]});
+    }
+    std::vector<SegmentRecord> rtreeSegments;
+    rtreeSegments.reserve(rtree.mItems.size());
+    for(const PackedRTree::Item &item : rtree.mItems)
+    {
+        rtreeSegments.push_back({item.edge->getIndex(), item.subwayId});
+    }
+
+    // Lay out the sections behind the header, each padded to the alignment
+    std::vector<char> payload;
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+
+    auto addSection = [&](Section section, const void *data, size_t count, size_t recordSize)
+    {
+        header.sections[section] = {sizeof(FileHeader) + payload.size(), count};
+        const char *bytes = static_cast<const char *>(data);
+        payload.insert(payload.end(), bytes, bytes + count * recordSize);
+        payload.resize(align(payload.size()), 0);
+    };
+
+    addSection(NODES, nodes.data(), nodes.size(), sizeof(NodeRecord));
+    addSection(EDGES, edges.data(), edges.size(), sizeof(EdgeRecord));
+    addSection(GEOMETRY, geometry.data(), geometry.size(), sizeof(PointRecord));
+    addSection(TAGS, tags.data(), tags.size(), sizeof(TagRecord));
+    addSection(STRING_OFFSETS, stringOffsets.data(), stringOffsets.size(), sizeof(uint32_t));
+    addSection(STRINGS, strings.data(), strings.size(), sizeof(char));
+    addSection(BOUNDARY, &boundaryRecord, 1, sizeof(BoxRecord));
+    addSection(RTREE_BOXES, rtreeBoxes.data(), rtreeBoxes.size(), sizeof(BoxRecord));
+    addSection(RTREE_LEVEL_OFFSETS, rtree.mLevelOffsets.data(), rtree.mLevelOffsets.size(), sizeof(uint32_t));
+    addSection(RTREE_SEGMENTS, rtreeSegments.data(), rtreeSegments.size(), sizeof(SegmentRecord));
+    addSection(RTREE_FIRST_CHILDREN, rtree.mFirstChildren.data(), rtree.mFirstChildren.size(), sizeof(uint32_t));
+
+    header.fileSize = sizeof(FileHeader) + payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload.data(), payload.size());
+    if(!file)
+    {
+        throw std::runtime_error("Cannot write graph snapshot " + filename);
+    }
+}
@@ -0,0 +1,104 @@
+#include "ingestfilter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+IngestFilter::IngestFilter()
+    : mKeptKeys{
+        "highway"/*, "surface", "tracktype", "smoothness", "lit",
+        "trail_visibility", "foot", "bicycle", "motor_vehicle", 
+        "access", "maxspeed", "sidewalk", "sidewalk:left", "sidewalk:right",*/
+    }
+{
+    requireTag("highway");
+}
+
+void IngestFilter::requireTag(const std::string &key, std::vector<std::string> values)
+{
+    mRules.push_back({key, std::move(values), false});
+}
+
+void IngestFilter::excludeTag(const std::string &key, std::vector<std::string> values)
+{
+    mRules.push_back({key, std::move(values), true});
+}
+
+void IngestFilter::setPolygon(std::vector<Coordinates> polygon)
+{
+    if(!polygon.empty() && polygon.size() < 3)
+    {
+        throw std::invalid_argument("Ingest polygon needs at least three points");
+    }
+
+    mPolygon = std::move(polygon);
+    mPolygonBounds.reset();
+    for(const Coordinates &point : mPolygon)
+    {
+        mPolygonBounds = mPolygonBounds ? Box(Coordinates(std::min(mPolygonBounds->getMinLatitudeLongitude().getLatitude(), point.getLatitude()),
+                                                          std::min(mPolygonBounds->getMinLatitudeLongitude().getLongitude(), point.getLongitude())),
+                                              Coordinates(std::max(mPolygonBounds->getMaxLatitudeLongitude().getLatitude(), point.getLatitude()),
+                                                          std::max(mPolygonBounds->getMaxLatitudeLongitude().getLongitude(), point.getLongitude())))
+                                        : Box(point, point);
+    }
+}
+
+std::vector<std::string> IngestFilter::getDecodedKeys() const
+{
+    std::vector<std::string> keys = mKeptKeys;
+    for(const TagRule &rule : mRules)
+    {
+        if(std::find(keys.begin(), keys.end(), rule.key) == keys.end())
+        {
+            keys.push_back(rule.key);
+        }
+    }
+    return keys;
+}
+
+bool IngestFilter::matches(const std::vector<std::pair<std::string, std::string>> &tags) const
+{
+    for(const TagRule &rule : mRules)
+    {
+        // Like Parameters::setParameter, a repeated key counts with its last value
+        const auto tag = std::find_if(tags.rbegin(), tags.rend(), [&](const auto &tag) { return tag.first == rule.key; });
+        const bool matched = tag != tags.rend() && (rule.values.empty() || std::find(rule.values.begin(), rule.values.end(), tag->second) != rule.values.end());
+        if(matched == rule.exclude)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IngestFilter::contains(const Coordinates &point) const
+{
+    if(mBoundingBox && !mBoundingBox->contains(point))
+    {
+        return false;
+    }
+    if(mPolygon.empty())
+    {
+        return true;
+    }
+    if(!mPolygonBounds->contains(point))
+    {
+        return false;
+    }
+
+    // Even-odd rule, casting a ray towards increasing longitude
+    bool inside = false;
+    for(size_t index = 0, previous = mPolygon.size() - 1; index < mPolygon.size(); previous = index++)
+    {
+        const Coordinates &a = mPolygon[index];
+        const Coordinates &b = mPolygon[previous];
+        if((a.getLatitude() > point.getLatitude()) != (b.getLatitude() > point.getLatitude()))
+        {
+            const double crossing = a.getLongitude() + (point.getLatitude() - a.getLatitude()) * (b.getLongitude() - a.getLongitude()) / (b.getLatitude() - a.getLatitude());
+            if(point.getLongitude() < crossing)
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
@@ -0,0 +1,271 @@
+#include "landmarks.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <type_traits>
+
+#include "graph.hpp"
+#include "weights.hpp"
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    // Integer tables store centimeters of cost
+    constexpr double FIXED_POINT_SCALE = 100.0;
+
+    struct ShortestPathTree
+    {
+        std::vector<double> costs;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> settleOrder;
+    };
+
+    ShortestPathTree dijkstra(const CsrGraph &csrGraph, const std::vector<double> &edgeCosts, const std::vector<uint32_t> &sources)
+    {
+        const uint32_t nodeCount = csrGraph.getNodeCount();
+        ShortestPathTree tree{std::vector<double>(nodeCount, std::numeric_limits<double>::infinity()), std::vector<uint32_t>(nodeCount, INVALID_INDEX), {}};
+        tree.settleOrder.reserve(nodeCount);
+
+        using QueueItem = std::pair<double, uint32_t>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        for(uint32_t source : sources)
+        {
+            tree.costs[source] = 0;
+            queue.emplace(0.0, source);
+        }
+
+        while(!queue.empty())
+        {
+            auto [cost, node] = queue.top();
+            queue.pop();
+            if(cost > tree.costs[node]) continue;
+            tree.settleOrder.push_back(node);
+
+            for(const CsrGraph::Arc &arc : csrGraph.getArcs(node))
+            {
+                const double newCost = cost + edgeCosts[arc.edge];
+                if(newCost < tree.costs[arc.target])
+                {
+                    tree.costs[arc.target] = newCost;
+                    tree.parents[arc.target] = node;
+                    queue.emplace(newCost, arc.target);
+                }
+            }
+        }
+        return tree;
+    }
+
+    uint32_t farthestNode(const ShortestPathTree &tree)
+    {
+        // Settle order is sorted by cost; unreachable nodes (other components) are never chosen
+        return tree.settleOrder.back();
+    }
+}
+
+template <typename Distance>
+Landmarks<Distance>::Landmarks(const Graph &graph, const CsrGraph &csrGraph, const Weights *weights, uint32_t landmarkCount, LandmarkSelection selection) : mWeighted(weights != nullptr)
+{
+    const uint32_t nodeCount = csrGraph.getNodeCount();
+    landmarkCount = std::min(landmarkCount, nodeCount);
+
+    std::vector<double> edgeCosts(csrGraph.getEdgeCount());
+    for(uint32_t edgeIndex = 0; edgeIndex < csrGraph.getEdgeCount(); edgeIndex++)
+    {
+        const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        edgeCosts[edgeIndex] = edge->getWeight() + edge->getWeight() * (weights ? weights->getWeight(edge->getParameters()) : 0.0);
+    }
+
+    // Distances are gathered landmark-major while selecting and transposed at the end
+    std::vector<std::vector<double>> landmarkCosts;
+    std::mt19937 random(42);
+
+    auto addLandmark = [&](uint32_t node)
+    {
+        mLandmarks.push_back(node);
+        landmarkCosts.push_back(dijkstra(csrGraph, edgeCosts, {node}).costs);
+    };
+
+    auto currentLowerBound = [&](uint32_t a, uint32_t b)
+    {
+        double lowerBound = 0;
+        for(const auto &costs : landmarkCosts)
+        {
+            if(std::isinf(costs[a]) || std::isinf(costs[b])) continue;
+            lowerBound = std::max(lowerBound, std::abs(costs[a] - costs[b]));
+        }
+        return lowerBound;
+    };
+
+    while(mLandmarks.size() < landmarkCount)
+    {
+        const uint32_t root = std::uniform_int_distribution<uint32_t>(0, nodeCount - 1)(random);
+
+        if(selection == LandmarkSelection::Farthest || mLandmarks.empty())
+        {
+            const ShortestPathTree tree = dijkstra(csrGraph, edgeCosts, mLandmarks.empty() ? std::vector<uint32_t>{root} : mLandmarks);
+            const uint32_t candidate = farthestNode(tree);
+            if(std::find(mLandmarks.begin(), mLandmarks.end(), candidate) != mLandmarks.end()) break;
+            addLandmark(candidate);
+            continue;
+        }
+
+        // Avoid: weight every node of a shortest path tree by how badly the current landmarks bound its distance to the root,
+        // then descend into the heaviest subtree without landmarks down to a leaf
+        const ShortestPathTree tree = dijkstra(csrGraph, edgeCosts, {root});
+        std::vector<double> sizes(nodeCount, 0.0);
+        std::vector<uint8_t> coveredSubtree(nodeCount, 0);
+        for(uint32_t landmark : mLandmarks) coveredSubtree[landmark] = 1;
+
+        for(auto it = tree.settleOrder.rbegin(); it != tree.settleOrder.rend(); ++it)
+        {
+            const uint32_t node = *it;
+            if(coveredSubtree[node])
+            {
+                sizes[node] = 0;
+            }
+            else
+            {
+                sizes[node] += tree.costs[node] - currentLowerBound(root, node);
+            }
+
+            const uint32_t parent = tree.parents[node];
+            if(parent != INVALID_INDEX)
+            {
+                sizes[parent] += sizes[node];
+                coveredSubtree[parent] |= coveredSubtree[node];
+            }
+        }
+
+        std::vector<uint32_t> childOffsets(nodeCount + 1, 0);
+        for(uint32_t node : tree.settleOrder)
+        {
+            if(tree.parents[node] != INVALID_INDEX) childOffsets[tree.parents[node] + 1]++;
+        }
+        for(uint32_t node = 0; node < nodeCount; node++) childOffsets[node + 1] += childOffsets[node];
+        std::vector<uint32_t> children(childOffsets.back());
+        std::vector<uint32_t> fill(childOffsets.begin(), childOffsets.end() - 1);
+        for(uint32_t node : tree.settleOrder)
+        {
+            if(tree.parents[node] != INVALID_INDEX) children[fill[tree.parents[node]]++] = node;
+        }
+
+        uint32_t candidate = root;
+        while(true)
+        {
+            uint32_t next = INVALID_INDEX;
+            for(uint32_t i = childOffsets[candidate]; i < childOffsets[candidate + 1]; i++)
+            {
+                if(sizes[children[i]] > 0 && (next == INVALID_INDEX || sizes[children[i]] > sizes[next])) next = children[i];
+            }
+            if(next == INVALID_INDEX) break;
+            candidate = next;
+        }
+
+        // Everything reachable from the root is covered already; fall back to the farthest node
+        if(coveredSubtree[candidate] || std::find(mLandmarks.begin(), mLandmarks.end(), candidate) != mLandmarks.end())
+        {
+            candidate = farthestNode(dijkstra(csrGraph, edgeCosts, mLandmarks));
+            if(std::find(mLandmarks.begin(), mLandmarks.end(), candidate) != mLandmarks.end()) break;
+        }
+        addLandmark(candidate);
+    }
+
+    const size_t count = mLandmarks.size();
+    mDistances.resize(static_cast<size_t>(nodeCount) * count);
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        for(size_t landmark = 0; landmark < count; landmark++)
+        {
+            mDistances[node * count + landmark] = fromCost(landmarkCosts[landmark][node]);
+        }
+    }
+}
+
+template <typename Distance>
+Distance Landmarks<Distance>::fromCost(double cost)
+{
+    if(std::isinf(cost)) return UNREACHABLE;
+    if constexpr (std::is_integral_v<Distance>)
+    {
+        return static_cast<Distance>(std::min(std::round(cost * FIXED_POINT_SCALE), static_cast<double>(UNREACHABLE - 1)));
+    }
+    else
+    {
+        return static_cast<Distance>(cost);
+    }
+}
+
+template <typename Distance>
+double Landmarks<Distance>::toCost(Distance distance)
+{
+    if(distance == UNREACHABLE) return std::numeric_limits<double>::infinity();
+    if constexpr (std::is_integral_v<Distance>)
+    {
+        return distance / FIXED_POINT_SCALE;
+    }
+    else
+    {
+        return distance;
+    }
+}
+
+template <typename Distance>
+void Landmarks<Distance>::getDistances(uint32_t node, double *distances) const
+{
+    const Distance *row = mDistances.data() + static_cast<size_t>(node) * mLandmarks.size();
+    for(size_t landmark = 0; landmark < mLandmarks.size(); landmark++)
+    {
+        distances[landmark] = toCost(row[landmark]);
+    }
+}
+
+template <typename Distance>
+double Landmarks<Distance>::getLowerBound(uint32_t node, const double *distances) const
+{
+    const Distance *row = mDistances.data() + static_cast<size_t>(node) * mLandmarks.size();
+    Bound bound;
+    for(size_t landmark = 0; landmark < mLandmarks.size(); landmark++)
+    {
+        bound.add(toCost(row[landmark]), distances[landmark]);
+    }
+    return bound.get();
+}
+
+template <typename Distance>
+double Landmarks<Distance>::getLowerBound(const double *from, const double *to) const
+{
+    Bound bound;
+    for(size_t landmark = 0; landmark < mLandmarks.size(); landmark++)
+    {
+        bound.add(from[landmark], to[landmark]);
+    }
+    return bound.get();
+}
+
+template <typename Distance>
+void Landmarks<Distance>::Bound::add(double from, double to)
+{
+    if(std::isinf(from) || std::isinf(to)) return;
+
+    const double difference = std::abs(from - to);
+    if(difference > lowerBound)
+    {
+        lowerBound = difference;
+        largest = std::max(from, to);
+    }
+}
+
+template <typename Distance>
+double Landmarks<Distance>::Bound::get() const
+{
+    // Give back the rounding of the stored distances so the bound stays admissible
+    const double slack = std::is_integral_v<Distance> ? 1.0 / FIXED_POINT_SCALE : largest * 1e-6;
+    return std::max(0.0, lowerBound - slack);
+}
+
+template class Landmarks<float>;
+template class Landmarks<uint32_t>;
@@ -1,24 +1,27 @@
 #include "library.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <filesystem>
-#include <unordered_set>
 #include <string>
 
-#include <libxml/xmlreader.h>
-
 #include "graph.hpp"
+#include "ingestfilter.hpp"
 #include "osmnode.hpp"
 #include "osmway.hpp"
+#include "osmxmlscanner.hpp"
 #include "parameters.hpp"
+#include "pbfreader.hpp"
 
 namespace HelperFunctions
 {
@@ -26,63 +29,6 @@ namespace HelperFunctions
     {
         constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
 
-        struct XmlParserGuard
-        {
-            XmlParserGuard() { xmlInitParser(); }
-            ~XmlParserGuard() { xmlCleanupParser(); }
-        };
-
-        struct XmlReaderGuard
-        {
-            explicit XmlReaderGuard(xmlTextReaderPtr readerPtr) : reader(readerPtr) {}
-            ~XmlReaderGuard()
-            {
-                if (reader)
-                {
-                    xmlFreeTextReader(reader);
-                }
-            }
-
-            xmlTextReaderPtr reader;
-        };
-
-        std::string getAttributeValue(xmlTextReaderPtr reader, const char *attributeName)
-        {
-            xmlChar *rawValue = xmlTextReaderGetAttribute(reader, BAD_CAST attributeName);
-            if (!rawValue)
-            {
-                return {};
-            }
-
-            std::string value(reinterpret_cast<const char *>(rawValue));
-            xmlFree(rawValue);
-            return value;
-        }
-
-        void processNodeElement(xmlTextReaderPtr reader, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes)
-        {
-            const std::string idStr = getAttributeValue(reader, "id");
-            const std::string latStr = getAttributeValue(reader, "lat");
-            const std::string lonStr = getAttributeValue(reader, "lon");
-
-            if (idStr.empty() || latStr.empty() || lonStr.empty())
-            {
-                return;
-            }
-
-            try
-            {
-                const uint64_t id = std::stoull(idStr);
-                const double lat = std::stod(latStr);
-                const double lon = std::stod(lonStr);
-                nodes.try_emplace(id, std::make_shared<OsmNode>(id, lat, lon));
-            }
-            catch (const std::exception &)
-            {
-                // Ungültige Werte werden ignoriert.
-            }
-        }
-
         void combineTags(Parameters& params, const std::string& key1, const std::string& key2)
         {
             std::string v1 = params.getParameter(key1);
@@ -95,96 +41,9 @@ namespace HelperFunctions
             }
         }
 
-        void processWayElement(xmlTextReaderPtr reader, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
+        // Links a highway to its nodes and marks junctions
+        void addWay(uint64_t wayId, const std::vector<uint64_t> &nodeRefs, const Parameters &wayParameters, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
         {
-            const std::string idStr = getAttributeValue(reader, "id");
-            if (idStr.empty())
-            {
-                return;
-            }
-
-            uint64_t wayId = 0;
-            try
-            {
-                wayId = std::stoull(idStr);
-            }
-            catch (const std::exception &)
-            {
-                return;
-            }
-
-            bool isHighway = false;
-            std::vector<uint64_t> nodeRefs;
-            Parameters wayParameters;
-
-            static const std::unordered_set<std::string> relevantKeys = {
-                "highway"/*, "surface", "tracktype", "smoothness", "lit",
-                "trail_visibility", "foot", "bicycle", "motor_vehicle", 
-                "access", "maxspeed", "sidewalk", "sidewalk:left", "sidewalk:right",*/
-            };
-
-            // 1. VOR dem XML-Loop: Alles fair auf "unknown" initialisieren
-            for (const auto& key : relevantKeys) {
-                wayParameters.setParameter(key, "unknown");
-            }
-
-            if (!xmlTextReaderIsEmptyElement(reader))
-            {
-                const int baseDepth = xmlTextReaderDepth(reader);
-                while (xmlTextReaderRead(reader) == 1)
-                {
-                    const int nodeType = xmlTextReaderNodeType(reader);
-                    if (nodeType == XML_READER_TYPE_ELEMENT)
-                    {
-                        const xmlChar *childName = xmlTextReaderConstName(reader);
-                        if (!childName)
-                        {
-                            continue;
-                        }
-
-                        if (xmlStrcmp(childName, BAD_CAST "tag") == 0)
-                        {
-                            std::string key = getAttributeValue(reader, "k");
-                            
-                            if (relevantKeys.find(key) != relevantKeys.end())
-                            {
-                                std::string value = getAttributeValue(reader, "v");
-                                wayParameters.setParameter(key, value);
-                                
-                                if (key == "highway")
-                                {
-                                    isHighway = true;
-                                }
-                            }
-                        }
-                        else if (xmlStrcmp(childName, BAD_CAST "nd") == 0)
-                        {
-                            const std::string refStr = getAttributeValue(reader, "ref");
-                            if (!refStr.empty())
-                            {
-                                try
-                                {
-                                    nodeRefs.push_back(std::stoull(refStr));
-                                }
-                                catch (const std::exception &)
-                                {
-                                    // Ignorieren, falls ref ungültig ist.
-                                }
-                            }
-                        }
-                    }
-                    else if (nodeType == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == baseDepth)
-                    {
-                        break;
-                    }
-                }
-            }
-
-            if (!isHighway)
-            {
-                return;
-            }
-
             auto way = std::make_unique<OsmWay>(wayId);
 
             for (uint64_t nodeId : nodeRefs)
@@ -224,6 +83,78 @@ namespace HelperFunctions
 
             ways[wayId] = std::move(way);
         }
+
+        // Kept tags of a way, "unknown" where missing; empty if the filter rejects the way
+        std::optional<Parameters> getWayParameters(const OsmBlock::Way &osmWay, const IngestFilter &filter)
+        {
+            if (!filter.matches(osmWay.tags))
+            {
+                return std::nullopt;
+            }
+
+            TagDictionary &dictionary = TagDictionary::getInstance();
+            std::vector<Tag> tags;
+
+            // Alles fair auf "unknown" initialisieren; spätere Tags überschreiben frühere
+            const uint32_t unknown = dictionary.intern("unknown");
+            for (const auto &key : filter.getKeptKeys())
+            {
+                tags.push_back({dictionary.intern(key), unknown});
+            }
+            for (const auto &[key, value] : osmWay.tags)
+            {
+                if (std::find(filter.getKeptKeys().begin(), filter.getKeptKeys().end(), key) != filter.getKeptKeys().end())
+                {
+                    tags.push_back({dictionary.intern(key), dictionary.intern(value)});
+                }
+            }
+            return Parameters(std::move(tags));
+        }
+
+        // Shared by the XML and PBF readers; blocks arrive in file order, so nodes precede the ways referencing them
+        void addBlock(OsmBlock &&block, const IngestFilter &filter, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
+        {
+            for (const OsmBlock::Node &node : block.nodes)
+            {
+                nodes.try_emplace(node.id, std::make_shared<OsmNode>(node.id, node.latitude, node.longitude));
+            }
+
+            for (const OsmBlock::Way &osmWay : block.ways)
+            {
+                if (std::optional<Parameters> wayParameters = getWayParameters(osmWay, filter))
+                {
+                    addWay(osmWay.id, osmWay.nodeRefs, *wayParameters, nodes, ways);
+                }
+            }
+        }
+
+        void readBlocks(const std::string &filepath, const IngestFilter &filter, OsmBlock::Content content, const std::function<void(OsmBlock &&)> &consumer, unsigned threadCount)
+        {
+            const std::vector<std::string> wayKeys = filter.getDecodedKeys();
+            if (filepath.ends_with(".pbf"))
+            {
+                PbfReader(filepath, wayKeys, content).read(consumer, threadCount);
+            }
+            else
+            {
+                OsmXmlScanner(filepath, wayKeys, content).read(consumer, threadCount);
+            }
+        }
+
+        void eraseUnvisitedNodes(ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes)
+        {
+            for (auto it = nodes.begin(); it != nodes.end();)
+            {
+                if (!it->second->isVisited)
+                {
+                    it = nodes.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
     }
 
     // Haversine formula to calculate the great-circle distance between two points in meters
@@ -276,7 +207,7 @@ namespace HelperFunctions
     }
     
 
-    double calculatePathLength(const std::vector<Coordinates> &path)
+    double calculatePathLength(std::span<const Coordinates> path)
     {
         double totalLength = 0.0;
 
@@ -372,79 +303,276 @@ namespace HelperFunctions
 
     void readOSMFile(const std::string &filepath, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
     {
-        XmlParserGuard parserGuard;
-        xmlTextReaderPtr readerPtr = xmlReaderForFile(filepath.c_str(), nullptr, XML_PARSE_NOBLANKS | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
-        if (!readerPtr)
+        if (filepath.ends_with(".pbf"))
         {
-            throw std::runtime_error("Error reading OSM file: " + filepath);
+            readPBFFile(filepath, nodes, ways);
+            return;
         }
 
-        XmlReaderGuard reader(readerPtr);
+        // Chunks are scanned in parallel and merged here in file order
+        const IngestFilter filter;
+        readBlocks(filepath, filter, OsmBlock::ALL, [&](OsmBlock &&block)
+        {
+            addBlock(std::move(block), filter, nodes, ways);
+        }, 0);
+
+        eraseUnvisitedNodes(nodes);
+    }
 
-        int ret = 0;
-        while ((ret = xmlTextReaderRead(reader.reader)) == 1)
+    void readPBFFile(const std::string &filepath, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways, unsigned threadCount)
+    {
+        // Blocks are decoded in parallel and merged here in file order, so the result matches the XML reader
+        const IngestFilter filter;
+        PbfReader reader(filepath, filter.getDecodedKeys());
+        reader.read([&](OsmBlock &&block)
         {
-            if (xmlTextReaderNodeType(reader.reader) != XML_READER_TYPE_ELEMENT)
-            {
-                continue;
-            }
+            addBlock(std::move(block), filter, nodes, ways);
+        }, threadCount);
 
-            const xmlChar *nodeName = xmlTextReaderConstName(reader.reader);
-            if (!nodeName)
-            {
-                continue;
-            }
+        eraseUnvisitedNodes(nodes);
+    }
 
-            if (xmlStrcmp(nodeName, BAD_CAST "node") == 0)
-            {
-                processNodeElement(reader.reader, nodes);
-            }
-            else if (xmlStrcmp(nodeName, BAD_CAST "way") == 0)
-            {
-                processWayElement(reader.reader, nodes, ways);
-            }
+    const Box createGraph(Graph &graph, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
+    {
+        double minLat = std::numeric_limits<double>::max();
+        double minLon = std::numeric_limits<double>::max();
+        double maxLat = std::numeric_limits<double>::lowest();
+        double maxLon = std::numeric_limits<double>::lowest();
+
+        // Insert in OSM-ID order, so the dense graph indices follow the file order instead of the hash map order
+        std::vector<OsmNode *> sortedNodes;
+        sortedNodes.reserve(nodes.size());
+        for (auto &node : nodes)
+        {
+            sortedNodes.push_back(node.second.get());
         }
+        std::sort(sortedNodes.begin(), sortedNodes.end(), [](const OsmNode *a, const OsmNode *b) { return a->getId() < b->getId(); });
 
-        if (ret < 0)
+        for (OsmNode *node : sortedNodes)
+        {
+            graph.addOsmNode(nodes.at(node->getId()));
+            const double lat = node->getCoordinates().getLatitude();
+            const double lon = node->getCoordinates().getLongitude();
+
+            if (lat < minLat) minLat = lat;
+            if (lat > maxLat) maxLat = lat;
+            if (lon < minLon) minLon = lon;
+            if (lon > maxLon) maxLon = lon;
+        }
+
+        std::vector<const OsmWay *> sortedWays;
+        sortedWays.reserve(ways.size());
+        for (auto &way : ways)
         {
-            throw std::runtime_error("XML parsing error in file: " + filepath);
+            sortedWays.push_back(way.second.get());
         }
+        std::sort(sortedWays.begin(), sortedWays.end(), [](const OsmWay *a, const OsmWay *b) { return a->getId() < b->getId(); });
 
-        for (auto it = nodes.begin(); it != nodes.end();)
+        for (const OsmWay *way : sortedWays)
         {
-            if (!it->second->isVisited)
+            graph.addOsmWay(way);
+        }
+
+        return Box(Coordinates(minLat, minLon), Coordinates(maxLat, maxLon));
+    }
+
+    const Box readOSMGraph(const std::string &filepath, Graph &graph, const IngestFilter &filter, unsigned threadCount)
+    {
+        // Pass 1: matching ways with their node references in one pool
+        struct WayEntry
+        {
+            uint64_t id;
+            size_t refOffset;
+            size_t refCount;
+            Parameters parameters;
+            size_t pieceOffset = 0;
+            size_t pieceCount = 0;
+        };
+        std::vector<WayEntry> wayEntries;
+        std::vector<uint64_t> refs;
+
+        readBlocks(filepath, filter, OsmBlock::WAYS, [&](OsmBlock &&block)
+        {
+            for (OsmBlock::Way &osmWay : block.ways)
             {
-                it = nodes.erase(it);
+                if (std::optional<Parameters> wayParameters = getWayParameters(osmWay, filter))
+                {
+                    wayEntries.push_back({osmWay.id, refs.size(), osmWay.nodeRefs.size(), std::move(*wayParameters)});
+                    refs.insert(refs.end(), osmWay.nodeRefs.begin(), osmWay.nodeRefs.end());
+                }
             }
-            else
+        }, threadCount);
+
+        // Referenced node IDs, sorted; visits saturate at 2, which already makes a node a junction
+        std::vector<uint64_t> nodeIds(refs);
+        std::sort(nodeIds.begin(), nodeIds.end());
+        std::vector<uint8_t> visits;
+        size_t uniqueCount = 0;
+        for (size_t index = 0; index < nodeIds.size(); index++)
+        {
+            if (uniqueCount > 0 && nodeIds[uniqueCount - 1] == nodeIds[index])
             {
-                ++it;
+                visits[uniqueCount - 1] = 2;
+                continue;
             }
+            nodeIds[uniqueCount++] = nodeIds[index];
+            visits.push_back(1);
         }
-    }
+        nodeIds.resize(uniqueCount);
+        nodeIds.shrink_to_fit();
+
+        auto findNode = [&](uint64_t nodeId)
+        {
+            return static_cast<size_t>(std::lower_bound(nodeIds.begin(), nodeIds.end(), nodeId) - nodeIds.begin());
+        };
+
+        // Pass 2: coordinates of the referenced nodes only; the first occurrence of an ID wins
+        enum NodeState : uint8_t { MISSING, FOUND, OUTSIDE };
+        std::vector<Coordinates> coordinates(nodeIds.size(), Coordinates(0.0, 0.0));
+        std::vector<uint8_t> nodeStates(nodeIds.size(), MISSING);
+        readBlocks(filepath, filter, OsmBlock::NODES, [&](OsmBlock &&block)
+        {
+            for (const OsmBlock::Node &node : block.nodes)
+            {
+                const size_t index = findNode(node.id);
+                if (index < nodeIds.size() && nodeIds[index] == node.id && nodeStates[index] == MISSING)
+                {
+                    coordinates[index] = Coordinates(node.latitude, node.longitude);
+                    nodeStates[index] = filter.contains(coordinates[index]) ? FOUND : OUTSIDE;
+                }
+            }
+        }, threadCount);
+
+        // Split the ways into pieces of consecutive nodes inside the area, skipping missing nodes,
+        // and mark the endpoints of every piece with at least two nodes
+        struct WayPiece
+        {
+            size_t refOffset;
+            size_t refCount;
+        };
+        std::vector<WayPiece> pieces;
+        std::vector<uint32_t> refIndices;
+        refIndices.reserve(refs.size());
 
-    const Box createGraph(Graph &graph, ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> &nodes, ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> &ways)
-    {
         double minLat = std::numeric_limits<double>::max();
         double minLon = std::numeric_limits<double>::max();
         double maxLat = std::numeric_limits<double>::lowest();
         double maxLon = std::numeric_limits<double>::lowest();
 
-        for (auto &node : nodes)
+        ankerl::unordered_dense::map<uint64_t, size_t> wayById;
+        for (size_t wayIndex = 0; wayIndex < wayEntries.size(); wayIndex++)
         {
-            graph.addOsmNode(node.second);
-            const double lat = node.second->getCoordinates().getLatitude();
-            const double lon = node.second->getCoordinates().getLongitude();
+            WayEntry &way = wayEntries[wayIndex];
+            way.pieceOffset = pieces.size();
 
-            if (lat < minLat) minLat = lat;
-            if (lat > maxLat) maxLat = lat;
-            if (lon < minLon) minLon = lon;
-            if (lon > maxLon) maxLon = lon;
+            size_t pieceBegin = refIndices.size();
+            auto closePiece = [&]()
+            {
+                const size_t refCount = refIndices.size() - pieceBegin;
+                if (refCount >= 2)
+                {
+                    visits[refIndices[pieceBegin]] = 2;
+                    visits[refIndices.back()] = 2;
+                    pieces.push_back({pieceBegin, refCount});
+                }
+                else
+                {
+                    refIndices.resize(pieceBegin);
+                }
+                pieceBegin = refIndices.size();
+            };
+
+            for (size_t ref = way.refOffset; ref < way.refOffset + way.refCount; ref++)
+            {
+                const size_t index = findNode(refs[ref]);
+                if (nodeStates[index] == MISSING)
+                {
+                    std::cerr << "Node with ID " << refs[ref] << " not found.\n";
+                    continue;
+                }
+                if (nodeStates[index] == OUTSIDE)
+                {
+                    closePiece();
+                    continue;
+                }
+                refIndices.push_back(static_cast<uint32_t>(index));
+
+                const double lat = coordinates[index].getLatitude();
+                const double lon = coordinates[index].getLongitude();
+                if (lat < minLat) minLat = lat;
+                if (lat > maxLat) maxLat = lat;
+                if (lon < minLon) minLon = lon;
+                if (lon > maxLon) maxLon = lon;
+            }
+            closePiece();
+
+            way.pieceCount = pieces.size() - way.pieceOffset;
+            if (way.pieceCount > 0)
+            {
+                wayById[way.id] = wayIndex;
+            }
         }
+        refs = {};
 
-        for (auto &way : ways)
+        // Junctions in OSM-ID order, then the ways in OSM-ID order, like createGraph
+        std::vector<uint32_t> graphIndices(nodeIds.size(), std::numeric_limits<uint32_t>::max());
+        for (size_t index = 0; index < nodeIds.size(); index++)
+        {
+            if (nodeStates[index] == FOUND && visits[index] >= 2)
+            {
+                graphIndices[index] = graph.addNode(nodeIds[index], coordinates[index])->getIndex();
+            }
+        }
+
+        std::vector<std::pair<uint64_t, size_t>> sortedWays(wayById.begin(), wayById.end());
+        std::sort(sortedWays.begin(), sortedWays.end());
+
+        // Every edge repeats the junction it starts at, so the pool holds the refs of each piece plus one point per further edge
+        size_t geometrySize = 0;
+        for (const auto &[wayId, wayIndex] : sortedWays)
+        {
+            const WayEntry &way = wayEntries[wayIndex];
+            for (size_t piece = way.pieceOffset; piece < way.pieceOffset + way.pieceCount; piece++)
+            {
+                const uint32_t *wayRefs = refIndices.data() + pieces[piece].refOffset;
+                geometrySize += pieces[piece].refCount;
+                for (size_t index = 1; index + 1 < pieces[piece].refCount; index++)
+                {
+                    geometrySize += visits[wayRefs[index]] >= 2;
+                }
+            }
+        }
+        graph.reserveGeometry(graph.getGeometrySize() + geometrySize);
+
+        std::vector<Coordinates> path;
+        for (const auto &[wayId, wayIndex] : sortedWays)
         {
-            graph.addOsmWay(way.second.get());
+            const WayEntry &way = wayEntries[wayIndex];
+            uint64_t subWayId = 0;
+            for (size_t piece = way.pieceOffset; piece < way.pieceOffset + way.pieceCount; piece++)
+            {
+                const uint32_t *wayRefs = refIndices.data() + pieces[piece].refOffset;
+                size_t startIndex = 0;
+                for (size_t index = 1; index < pieces[piece].refCount; index++)
+                {
+                    if (visits[wayRefs[index]] < 2)
+                    {
+                        continue;
+                    }
+
+                    path.clear();
+                    for (size_t pathIndex = startIndex; pathIndex <= index; pathIndex++)
+                    {
+                        path.push_back(coordinates[wayRefs[pathIndex]]);
+                    }
+
+                    // Same sub-way ID scheme as Graph::addOsmWay
+                    const double waylength = calculatePathLength(path);
+                    graph.addEdge(wayId | (subWayId++ << 56), waylength, graphIndices[wayRefs[startIndex]], graphIndices[wayRefs[index]], path, way.parameters);
+
+                    startIndex = index;
+                }
+            }
         }
 
         return Box(Coordinates(minLat, minLon), Coordinates(maxLat, maxLon));
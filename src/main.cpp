@@ -6,6 +6,8 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <ankerl/unordered_dense.h>
 
 #include "library.hpp"
@@ -26,7 +28,8 @@ int main(int argc, char *argv[])
     
     if(argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " <osm_file.osm> [port]\n";
+        std::cerr << "Usage: " << argv[0] << " <osm_file.osm | snapshot_file> [port] [profile=weights.csv ...]\n"
+                  << "Without profiles weightsnew.csv is loaded as profile \"" << Router::DEFAULT_PROFILE << "\".\n";
         return 1;
     }
     
@@ -42,11 +45,30 @@ int main(int argc, char *argv[])
         port = static_cast<uint16_t>(parsedPort);
     }
 
+    // All profiles share one graph; each request picks one of them over the socket
+    std::vector<std::pair<std::string, std::string>> profiles;
+    for (int i = 3; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        const size_t separator = argument.find('=');
+        if (separator == std::string::npos || separator == 0 || separator + 1 == argument.size())
+        {
+            std::cerr << "Ungueltiges Profil: " << argument << " (erwartet <name>=<gewichte.csv>)\n";
+            return 1;
+        }
+        profiles.emplace_back(argument.substr(0, separator), argument.substr(separator + 1));
+    }
+
     std::unique_ptr<Router> router;
 
     try
     {
-        router = std::make_unique<Router>(argv[1], "weightsnew.csv");
+        router = std::make_unique<Router>(argv[1], profiles.empty() ? "weightsnew.csv" : "");
+        for (const auto &[name, weightCSVFile] : profiles)
+        {
+            router->addProfile(name, weightCSVFile);
+            std::cout << "Profil " << name << " geladen aus " << weightCSVFile << "\n";
+        }
     }
     catch (const std::exception &e)
     {
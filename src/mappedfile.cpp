@@ -0,0 +1,67 @@
+#include "mappedfile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &filename)
+{
+#ifdef _WIN32
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    mBuffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(mBuffer.data(), mBuffer.size());
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+
+    struct stat status{};
+    if(::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot read " + filename);
+    }
+    mSize = static_cast<size_t>(status.st_size);
+
+    // Empty files cannot be mapped; they are represented by an empty view
+    if(mSize == 0)
+    {
+        ::close(fd);
+        mData = mBuffer.data();
+        return;
+    }
+
+    void *mapping = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Cannot map " + filename);
+    }
+    mData = static_cast<const char *>(mapping);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if(mSize > 0)
+    {
+        ::munmap(const_cast<char *>(mData), mSize);
+    }
+#endif
+}
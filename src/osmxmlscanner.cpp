@@ -0,0 +1,351 @@
+#include "osmxmlscanner.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+namespace
+{
+    // Chunks are scanned by threadCount threads at a time, then handed to the consumer; bounds the memory held at once
+    constexpr size_t CHUNK_SIZE = 16 * 1024 * 1024;
+
+    bool startsWith(const char *position, const char *end, std::string_view prefix)
+    {
+        return static_cast<size_t>(end - position) >= prefix.size() && std::memcmp(position, prefix.data(), prefix.size()) == 0;
+    }
+
+    bool isNameEnd(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>';
+    }
+
+    // position points behind '<'; true if the element name equals name
+    bool isElement(const char *position, const char *end, std::string_view name)
+    {
+        return startsWith(position, end, name) && position + name.size() < end && isNameEnd(position[name.size()]);
+    }
+
+    const char *find(const char *position, const char *end, char c)
+    {
+        const void *found = std::memchr(position, c, end - position);
+        return found ? static_cast<const char *>(found) : end;
+    }
+
+    const char *find(const char *position, const char *end, std::string_view text)
+    {
+        const std::string_view haystack(position, end - position);
+        const size_t found = haystack.find(text);
+        return found == std::string_view::npos ? end : position + found;
+    }
+
+    // Reads the attributes of the element whose name ends at position and calls visitor(name, rawValue) for each.
+    // Leaves position behind the closing '>' and returns true for self-closing elements.
+    template <typename Visitor>
+    bool readAttributes(const char *&position, const char *end, Visitor &&visitor)
+    {
+        while(position < end)
+        {
+            const char c = *position;
+            if(c == '>')
+            {
+                position++;
+                return false;
+            }
+            if(c == '/')
+            {
+                position = find(position, end, '>');
+                if(position < end) position++;
+                return true;
+            }
+            if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+                position++;
+                continue;
+            }
+
+            const char *nameBegin = position;
+            position = find(position, end, '=');
+            std::string_view name(nameBegin, position - nameBegin);
+            while(!name.empty() && (name.back() == ' ' || name.back() == '\t' || name.back() == '\n' || name.back() == '\r')) name.remove_suffix(1);
+
+            position++;
+            while(position < end && *position != '"' && *position != '\'') position++;
+            if(position >= end) return false;
+
+            const char quote = *position++;
+            const char *valueBegin = position;
+            position = find(position, end, quote);
+            visitor(name, std::string_view(valueBegin, position - valueBegin));
+            if(position < end) position++;
+        }
+        return false;
+    }
+
+    // Replaces the predefined and numeric character references
+    std::string decodeEntities(std::string_view raw)
+    {
+        std::string decoded;
+        decoded.reserve(raw.size());
+        for(size_t index = 0; index < raw.size(); index++)
+        {
+            if(raw[index] != '&')
+            {
+                decoded.push_back(raw[index]);
+                continue;
+            }
+
+            const size_t semicolon = raw.find(';', index);
+            if(semicolon == std::string_view::npos)
+            {
+                decoded.append(raw.substr(index));
+                break;
+            }
+
+            const std::string_view entity = raw.substr(index + 1, semicolon - index - 1);
+            if(entity == "amp") decoded.push_back('&');
+            else if(entity == "lt") decoded.push_back('<');
+            else if(entity == "gt") decoded.push_back('>');
+            else if(entity == "quot") decoded.push_back('"');
+            else if(entity == "apos") decoded.push_back('\'');
+            else if(!entity.empty() && entity[0] == '#')
+            {
+                const bool hex = entity.size() > 1 && (entity[1] == 'x' || entity[1] == 'X');
+                uint32_t codePoint = 0;
+                std::from_chars(entity.data() + (hex ? 2 : 1), entity.data() + entity.size(), codePoint, hex ? 16 : 10);
+
+                // UTF-8 encoding
+                if(codePoint < 0x80)
+                {
+                    decoded.push_back(static_cast<char>(codePoint));
+                }
+                else if(codePoint < 0x800)
+                {
+                    decoded.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                    decoded.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+                else if(codePoint < 0x10000)
+                {
+                    decoded.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                    decoded.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+                else
+                {
+                    decoded.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                    decoded.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+            }
+            else
+            {
+                decoded.append(raw.substr(index, semicolon - index + 1));
+            }
+            index = semicolon;
+        }
+        return decoded;
+    }
+
+    // Like std::stoull, negative IDs wrap around
+    bool parseId(std::string_view text, uint64_t &id)
+    {
+        const bool negative = !text.empty() && text[0] == '-';
+        uint64_t value = 0;
+        auto [end, error] = std::from_chars(text.data() + negative, text.data() + text.size(), value);
+        if(error != std::errc() || end == text.data() + negative) return false;
+        id = negative ? 0 - value : value;
+        return true;
+    }
+
+    bool parseDouble(std::string_view text, double &value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end != text.data();
+    }
+}
+
+OsmXmlScanner::OsmXmlScanner(const std::string &filepath, std::vector<std::string> wayKeys, OsmBlock::Content content)
+    : mFile(filepath), mWayKeys(std::move(wayKeys)), mContent(content)
+{
+}
+
+bool OsmXmlScanner::isWayKey(std::string_view key) const
+{
+    return std::find(mWayKeys.begin(), mWayKeys.end(), key) != mWayKeys.end();
+}
+
+std::vector<size_t> OsmXmlScanner::getChunkOffsets(size_t chunkSize) const
+{
+    const char *data = mFile.data();
+    const char *end = data + mFile.size();
+
+    // Values cannot contain a raw '<', so every '<' starts markup; node, way and relation elements do not nest.
+    // Markup inside comments is excluded by requiring the previous markup to be closed right before the element.
+    auto isBoundary = [&](const char *position)
+    {
+        const char *previous = position - 1;
+        while(previous > data && (*previous == ' ' || *previous == '\t' || *previous == '\n' || *previous == '\r')) previous--;
+        return previous > data && *previous == '>' &&
+               (isElement(position + 1, end, "node") || isElement(position + 1, end, "way") || isElement(position + 1, end, "relation"));
+    };
+
+    std::vector<size_t> offsets{0};
+    for(size_t target = chunkSize; target < mFile.size() && target > offsets.back(); target = offsets.back() + chunkSize)
+    {
+        const char *position = data + target;
+        while(true)
+        {
+            position = find(position, end, '<');
+            if(position >= end || isBoundary(position)) break;
+            position++;
+        }
+        if(position >= end) break;
+        offsets.push_back(position - data);
+    }
+    offsets.push_back(mFile.size());
+    return offsets;
+}
+
+OsmBlock OsmXmlScanner::scanChunk(size_t begin, size_t end) const
+{
+    OsmBlock block;
+    const char *position = mFile.data() + begin;
+    const char *chunkEnd = mFile.data() + end;
+
+    while(true)
+    {
+        position = find(position, chunkEnd, '<');
+        if(position >= chunkEnd) break;
+        position++;
+
+        if(startsWith(position, chunkEnd, "!--"))
+        {
+            position = find(position, chunkEnd, "-->");
+            continue;
+        }
+
+        // Unwanted elements and their children fall through to the generic skipping below
+        if((mContent & OsmBlock::NODES) && isElement(position, chunkEnd, "node"))
+        {
+            position += 4;
+            std::string_view idText, latText, lonText;
+            const bool selfClosing = readAttributes(position, chunkEnd, [&](std::string_view name, std::string_view value)
+            {
+                if(name == "id") idText = value;
+                else if(name == "lat") latText = value;
+                else if(name == "lon") lonText = value;
+            });
+
+            // Tags of nodes are not needed
+            if(!selfClosing) position = find(position, chunkEnd, "</node");
+
+            uint64_t id;
+            double latitude, longitude;
+            if(parseId(idText, id) && parseDouble(latText, latitude) && parseDouble(lonText, longitude))
+            {
+                block.nodes.push_back({id, latitude, longitude});
+            }
+        }
+        else if((mContent & OsmBlock::WAYS) && isElement(position, chunkEnd, "way"))
+        {
+            position += 3;
+            std::string_view idText;
+            const bool selfClosing = readAttributes(position, chunkEnd, [&](std::string_view name, std::string_view value)
+            {
+                if(name == "id") idText = value;
+            });
+
+            OsmBlock::Way way{0, {}, {}};
+            const bool valid = parseId(idText, way.id);
+
+            while(!selfClosing)
+            {
+                position = find(position, chunkEnd, '<');
+                if(position >= chunkEnd) break;
+                position++;
+
+                if(isElement(position, chunkEnd, "nd"))
+                {
+                    position += 2;
+                    readAttributes(position, chunkEnd, [&](std::string_view name, std::string_view value)
+                    {
+                        uint64_t ref;
+                        if(name == "ref" && parseId(value, ref)) way.nodeRefs.push_back(ref);
+                    });
+                }
+                else if(isElement(position, chunkEnd, "tag"))
+                {
+                    position += 3;
+                    std::string_view key, value;
+                    readAttributes(position, chunkEnd, [&](std::string_view name, std::string_view attribute)
+                    {
+                        if(name == "k") key = attribute;
+                        else if(name == "v") value = attribute;
+                    });
+
+                    std::string decodedKey = key.find('&') == std::string_view::npos ? std::string(key) : decodeEntities(key);
+                    if(isWayKey(decodedKey))
+                    {
+                        way.tags.emplace_back(std::move(decodedKey), value.find('&') == std::string_view::npos ? std::string(value) : decodeEntities(value));
+                    }
+                }
+                else if(startsWith(position, chunkEnd, "/way"))
+                {
+                    break;
+                }
+            }
+
+            if(valid) block.ways.push_back(std::move(way));
+        }
+        // Everything else (declaration, osm, bounds, relations and their members) is skipped element by element
+    }
+    return block;
+}
+
+void OsmXmlScanner::read(const std::function<void(OsmBlock &&)> &consumer, unsigned threadCount) const
+{
+    if(threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::vector<size_t> offsets = getChunkOffsets(CHUNK_SIZE);
+    const size_t chunkCount = offsets.size() - 1;
+
+    for(size_t batchBegin = 0; batchBegin < chunkCount; batchBegin += threadCount)
+    {
+        const size_t batchEnd = std::min<size_t>(chunkCount, batchBegin + threadCount);
+        std::vector<OsmBlock> blocks(batchEnd - batchBegin);
+        std::vector<std::exception_ptr> errors(blocks.size());
+
+        std::vector<std::thread> threads;
+        for(size_t chunk = batchBegin + 1; chunk < batchEnd; chunk++)
+        {
+            threads.emplace_back([&, chunk]()
+            {
+                try
+                {
+                    blocks[chunk - batchBegin] = scanChunk(offsets[chunk], offsets[chunk + 1]);
+                }
+                catch(...)
+                {
+                    errors[chunk - batchBegin] = std::current_exception();
+                }
+            });
+        }
+        blocks[0] = scanChunk(offsets[batchBegin], offsets[batchBegin + 1]);
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for(const auto &error : errors)
+        {
+            if(error) std::rethrow_exception(error);
+        }
+
+        for(OsmBlock &block : blocks)
+        {
+            consumer(std::move(block));
+        }
+    }
+}
@@ -0,0 +1,597 @@
+#include "packedrtree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "graphsnapshot.hpp"
+#include "library.hpp"
+
+namespace
+{
+    // Boxes of one level while the tree is built
+    struct LevelBoxes
+    {
+        std::vector<int32_t> minLatitudes;
+        std::vector<int32_t> minLongitudes;
+        std::vector<int32_t> maxLatitudes;
+        std::vector<int32_t> maxLongitudes;
+
+        size_t size() const { return minLatitudes.size(); }
+
+        void add(int32_t minLatitude, int32_t minLongitude, int32_t maxLatitude, int32_t maxLongitude)
+        {
+            minLatitudes.push_back(minLatitude);
+            minLongitudes.push_back(minLongitude);
+            maxLatitudes.push_back(maxLatitude);
+            maxLongitudes.push_back(maxLongitude);
+        }
+    };
+
+    // Sort-Tile-Recursive order: about sqrt(nodeCount) vertical slices by box center longitude, each slice sorted by latitude,
+    // so that every run of nodeSize boxes forms a compact tile
+    std::vector<uint32_t> sortTiles(const LevelBoxes &boxes, uint32_t nodeSize)
+    {
+        const size_t count = boxes.size();
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+
+        // Twice the center, which stays an integer
+        auto centerLatitude = [&](uint32_t box) { return static_cast<int64_t>(boxes.minLatitudes[box]) + boxes.maxLatitudes[box]; };
+        auto centerLongitude = [&](uint32_t box) { return static_cast<int64_t>(boxes.minLongitudes[box]) + boxes.maxLongitudes[box]; };
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return centerLongitude(a) < centerLongitude(b); });
+
+        const size_t nodeCount = (count + nodeSize - 1) / nodeSize;
+        const size_t sliceCount = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodeCount))));
+        const size_t sliceSize = (nodeCount + sliceCount - 1) / sliceCount * nodeSize;
+        for(size_t begin = 0; begin < count; begin += sliceSize)
+        {
+            const size_t end = std::min(begin + sliceSize, count);
+            std::sort(order.begin() + begin, order.begin() + end, [&](uint32_t a, uint32_t b) { return centerLatitude(a) < centerLatitude(b); });
+        }
+        return order;
+    }
+
+    constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+    constexpr double EARTH_RADIUS_M = HelperFunctions::EARTH_RADIUS_KM * 1000.0;
+
+    // Beyond this planar distance the kernel's lower bound is not trusted and the segment is measured exactly
+    constexpr double PLANAR_RANGE_M = 100000.0;
+    // Covers the rounding of the projected point to fixed point and the float error of the kernel
+    constexpr double PLANAR_TOLERANCE_M = 0.05;
+
+    // Squared planar distances from (latitude, longitude) to count segments, count a multiple of 8, all in degrees.
+    // t is taken along the unscaled coordinates like in HelperFunctions::getProjectionOnSegment, so the foot is the point
+    // the exact distance is measured to; only the distance to it is scaled by cosLatitude.
+    void computeSegmentDistances(const float *startLatitudes, const float *startLongitudes, const float *deltaLatitudes, const float *deltaLongitudes,
+                                 uint32_t count, float latitude, float longitude, float cosLatitude, float *squaredDistances)
+    {
+#if defined(__AVX__)
+        const __m256 pointLatitude = _mm256_set1_ps(latitude);
+        const __m256 pointLongitude = _mm256_set1_ps(longitude);
+        const __m256 scale = _mm256_set1_ps(cosLatitude);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 minLength = _mm256_set1_ps(FLT_MIN);
+        for(uint32_t i = 0; i < count; i += 8)
+        {
+            const __m256 dy = _mm256_loadu_ps(deltaLatitudes + i);
+            const __m256 dx = _mm256_loadu_ps(deltaLongitudes + i);
+            const __m256 vy = _mm256_sub_ps(pointLatitude, _mm256_loadu_ps(startLatitudes + i));
+            const __m256 vx = _mm256_sub_ps(pointLongitude, _mm256_loadu_ps(startLongitudes + i));
+
+            const __m256 length = _mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(dy, dy), _mm256_mul_ps(dx, dx)), minLength);
+            __m256 t = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(vy, dy), _mm256_mul_ps(vx, dx)), length);
+            t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+
+            const __m256 ey = _mm256_sub_ps(vy, _mm256_mul_ps(t, dy));
+            const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(vx, _mm256_mul_ps(t, dx)), scale);
+            _mm256_storeu_ps(squaredDistances + i, _mm256_add_ps(_mm256_mul_ps(ey, ey), _mm256_mul_ps(ex, ex)));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 pointLatitude = _mm_set1_ps(latitude);
+        const __m128 pointLongitude = _mm_set1_ps(longitude);
+        const __m128 scale = _mm_set1_ps(cosLatitude);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 minLength = _mm_set1_ps(FLT_MIN);
+        for(uint32_t i = 0; i < count; i += 4)
+        {
+            const __m128 dy = _mm_loadu_ps(deltaLatitudes + i);
+            const __m128 dx = _mm_loadu_ps(deltaLongitudes + i);
+            const __m128 vy = _mm_sub_ps(pointLatitude, _mm_loadu_ps(startLatitudes + i));
+            const __m128 vx = _mm_sub_ps(pointLongitude, _mm_loadu_ps(startLongitudes + i));
+
+            const __m128 length = _mm_max_ps(_mm_add_ps(_mm_mul_ps(dy, dy), _mm_mul_ps(dx, dx)), minLength);
+            __m128 t = _mm_div_ps(_mm_add_ps(_mm_mul_ps(vy, dy), _mm_mul_ps(vx, dx)), length);
+            t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+            const __m128 ey = _mm_sub_ps(vy, _mm_mul_ps(t, dy));
+            const __m128 ex = _mm_mul_ps(_mm_sub_ps(vx, _mm_mul_ps(t, dx)), scale);
+            _mm_storeu_ps(squaredDistances + i, _mm_add_ps(_mm_mul_ps(ey, ey), _mm_mul_ps(ex, ex)));
+        }
+#else
+        for(uint32_t i = 0; i < count; i++)
+        {
+            const float dy = deltaLatitudes[i];
+            const float dx = deltaLongitudes[i];
+            const float vy = latitude - startLatitudes[i];
+            const float vx = longitude - startLongitudes[i];
+
+            const float length = std::max(dy * dy + dx * dx, FLT_MIN);
+            const float t = std::clamp((vy * dy + vx * dx) / length, 0.0f, 1.0f);
+
+            const float ey = vy - t * dy;
+            const float ex = (vx - t * dx) * cosLatitude;
+            squaredDistances[i] = ey * ey + ex * ex;
+        }
+#endif
+    }
+
+    // The planar distance of the kernel is scaled to the latitude of the point. Against the haversine distance it errs by less
+    // than tan(latitude) d / 2R relative to d, so it is lowered by (1 + tan(latitude)) d / R to stay a lower bound.
+    struct PlanarBound
+    {
+        float cosLatitude;
+        double curvature;
+
+        explicit PlanarBound(const Coordinates &point)
+        {
+            const double latitude = point.getLatitude() * DEG_TO_RAD;
+            cosLatitude = static_cast<float>(std::cos(latitude));
+            curvature = (1.0 + std::abs(std::tan(latitude))) / EARTH_RADIUS_M;
+        }
+
+        // Lower bound in metres for the exact distance to a segment the kernel measured
+        double getLowerBound(float squaredDistance) const
+        {
+            const double planar = std::sqrt(static_cast<double>(squaredDistance)) * DEG_TO_RAD * EARTH_RADIUS_M;
+            return planar < PLANAR_RANGE_M ? planar * (1.0 - curvature * planar) - PLANAR_TOLERANCE_M : 0.0;
+        }
+    };
+
+    constexpr uint32_t HILBERT_CELLS = 1 << 16;
+
+    // Position of cell (x, y) along a Hilbert curve through a HILBERT_CELLS x HILBERT_CELLS grid
+    uint32_t getHilbertIndex(uint32_t x, uint32_t y)
+    {
+        uint32_t index = 0;
+        for(uint32_t size = HILBERT_CELLS / 2; size > 0; size /= 2)
+        {
+            const uint32_t rx = (x & size) > 0;
+            const uint32_t ry = (y & size) > 0;
+            index += size * size * ((3 * rx) ^ ry);
+
+            // Rotate the quadrant so that the curve continues in the right direction
+            if(ry == 0)
+            {
+                if(rx == 1)
+                {
+                    x = HILBERT_CELLS - 1 - x;
+                    y = HILBERT_CELLS - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
+}
+
+PackedRTree::PackedRTree(const Graph &graph) : mBoundary(Coordinates(0.0, 0.0), Coordinates(0.0, 0.0))
+{
+    LevelBoxes level;
+    std::vector<Item> items;
+    for(uint32_t edgeIndex = 0; edgeIndex < graph.getEdgeCount(); edgeIndex++)
+    {
+        Edge *edge = graph.getEdgeByIndex(edgeIndex);
+        const size_t segmentCount = edge->getPath().size() - 1;
+        for(size_t subwayId = 0; subwayId < segmentCount; subwayId++)
+        {
+            const Box box = edge->getBoundingBox(subwayId);
+            level.add(box.getMinLatitudeLongitude().getFixedLatitude(), box.getMinLatitudeLongitude().getFixedLongitude(),
+                      box.getMaxLatitudeLongitude().getFixedLatitude(), box.getMaxLatitudeLongitude().getFixedLongitude());
+            items.push_back({edge, static_cast<uint8_t>(subwayId)});
+        }
+    }
+
+    if(items.empty())
+    {
+        return;
+    }
+
+    // Each level is put into tile order, appended, and grouped into the nodes of the next level until one root remains
+    std::vector<uint32_t> firstChildren;
+    bool isItemLevel = true;
+    mLevelOffsets.push_back(0);
+    while(true)
+    {
+        const std::vector<uint32_t> order = sortTiles(level, NODE_SIZE);
+        const uint32_t levelOffset = mLevelOffsets.back();
+        for(uint32_t box : order)
+        {
+            mMinLatitudes.push_back(level.minLatitudes[box]);
+            mMinLongitudes.push_back(level.minLongitudes[box]);
+            mMaxLatitudes.push_back(level.maxLatitudes[box]);
+            mMaxLongitudes.push_back(level.maxLongitudes[box]);
+            if(isItemLevel)
+            {
+                mItems.push_back(items[box]);
+            }
+            else
+            {
+                mFirstChildren.push_back(firstChildren[box]);
+            }
+        }
+        mLevelOffsets.push_back(static_cast<uint32_t>(mMinLatitudes.size()));
+        isItemLevel = false;
+
+        // A single segment still gets a root node above it
+        if(order.size() == 1 && !mFirstChildren.empty())
+        {
+            break;
+        }
+
+        LevelBoxes parents;
+        firstChildren.clear();
+        for(uint32_t begin = levelOffset; begin < mLevelOffsets.back(); begin += NODE_SIZE)
+        {
+            const uint32_t end = std::min(begin + NODE_SIZE, mLevelOffsets.back());
+            parents.add(*std::min_element(mMinLatitudes.begin() + begin, mMinLatitudes.begin() + end),
+                        *std::min_element(mMinLongitudes.begin() + begin, mMinLongitudes.begin() + end),
+                        *std::max_element(mMaxLatitudes.begin() + begin, mMaxLatitudes.begin() + end),
+                        *std::max_element(mMaxLongitudes.begin() + begin, mMaxLongitudes.begin() + end));
+            firstChildren.push_back(begin);
+        }
+        level = std::move(parents);
+    }
+
+    const uint32_t root = mLevelOffsets[mLevelOffsets.size() - 2];
+    mBoundary = Box(Coordinates::fromFixedPoint(mMinLatitudes[root], mMinLongitudes[root]),
+                    Coordinates::fromFixedPoint(mMaxLatitudes[root], mMaxLongitudes[root]));
+
+    compileLeafSegments();
+}
+
+PackedRTree::PackedRTree(const Graph &graph, const GraphSnapshot &snapshot)
+    : mLevelOffsets(snapshot.getRTreeLevelOffsets().begin(), snapshot.getRTreeLevelOffsets().end()),
+      mFirstChildren(snapshot.getRTreeFirstChildren().begin(), snapshot.getRTreeFirstChildren().end()),
+      mBoundary(Coordinates(0.0, 0.0), Coordinates(0.0, 0.0))
+{
+    const std::span<const GraphSnapshot::BoxRecord> boxes = snapshot.getRTreeBoxes();
+    mMinLatitudes.reserve(boxes.size());
+    mMinLongitudes.reserve(boxes.size());
+    mMaxLatitudes.reserve(boxes.size());
+    mMaxLongitudes.reserve(boxes.size());
+    for(const GraphSnapshot::BoxRecord &box : boxes)
+    {
+        mMinLatitudes.push_back(box.minLatitude);
+        mMinLongitudes.push_back(box.minLongitude);
+        mMaxLatitudes.push_back(box.maxLatitude);
+        mMaxLongitudes.push_back(box.maxLongitude);
+    }
+
+    mItems.reserve(snapshot.getRTreeSegments().size());
+    for(const GraphSnapshot::SegmentRecord &segment : snapshot.getRTreeSegments())
+    {
+        mItems.push_back({graph.getEdgeByIndex(segment.edge), static_cast<uint8_t>(segment.subwayId)});
+    }
+
+    if(mItems.empty())
+    {
+        return;
+    }
+
+    const uint32_t root = mLevelOffsets[mLevelOffsets.size() - 2];
+    mBoundary = Box(Coordinates::fromFixedPoint(mMinLatitudes[root], mMinLongitudes[root]),
+                    Coordinates::fromFixedPoint(mMaxLatitudes[root], mMaxLongitudes[root]));
+
+    compileLeafSegments();
+}
+
+void PackedRTree::compileLeafSegments()
+{
+    // Every leaf owns the NODE_SIZE slots starting at its first child; unused slots stay zero
+    const uint32_t itemCount = static_cast<uint32_t>(mItems.size());
+    const size_t slotCount = (itemCount + NODE_SIZE - 1) / NODE_SIZE * NODE_SIZE;
+    mSegmentStartLatitudes.assign(slotCount, 0.0f);
+    mSegmentStartLongitudes.assign(slotCount, 0.0f);
+    mSegmentDeltaLatitudes.assign(slotCount, 0.0f);
+    mSegmentDeltaLongitudes.assign(slotCount, 0.0f);
+
+    auto toDegrees = [](int64_t fixed) { return static_cast<float>(fixed / Coordinates::FIXED_POINT_SCALE); };
+
+    for(uint32_t leaf = mLevelOffsets[1]; leaf < mLevelOffsets[2]; leaf++)
+    {
+        const uint32_t firstChild = mFirstChildren[leaf - itemCount];
+        const uint32_t lastChild = std::min(firstChild + NODE_SIZE, itemCount);
+        for(uint32_t child = firstChild; child < lastChild; child++)
+        {
+            const auto path = mItems[child].edge->getPath();
+            const Coordinates &start = path[mItems[child].subwayId];
+            const Coordinates &end = path[mItems[child].subwayId + 1];
+            mSegmentStartLatitudes[child] = toDegrees(static_cast<int64_t>(start.getFixedLatitude()) - mMinLatitudes[leaf]);
+            mSegmentStartLongitudes[child] = toDegrees(static_cast<int64_t>(start.getFixedLongitude()) - mMinLongitudes[leaf]);
+            mSegmentDeltaLatitudes[child] = toDegrees(static_cast<int64_t>(end.getFixedLatitude()) - start.getFixedLatitude());
+            mSegmentDeltaLongitudes[child] = toDegrees(static_cast<int64_t>(end.getFixedLongitude()) - start.getFixedLongitude());
+        }
+    }
+}
+
+void PackedRTree::computeLeafDistances(const Coordinates &point, uint32_t leaf, float cosLatitude, float *squaredDistances) const
+{
+    const uint32_t firstChild = mFirstChildren[leaf - mItems.size()];
+    const float latitude = static_cast<float>((static_cast<int64_t>(point.getFixedLatitude()) - mMinLatitudes[leaf]) / Coordinates::FIXED_POINT_SCALE);
+    const float longitude = static_cast<float>((static_cast<int64_t>(point.getFixedLongitude()) - mMinLongitudes[leaf]) / Coordinates::FIXED_POINT_SCALE);
+    computeSegmentDistances(mSegmentStartLatitudes.data() + firstChild, mSegmentStartLongitudes.data() + firstChild,
+                            mSegmentDeltaLatitudes.data() + firstChild, mSegmentDeltaLongitudes.data() + firstChild,
+                            NODE_SIZE, latitude, longitude, cosLatitude, squaredDistances);
+}
+
+// Lower bound for the distance of any segment inside the box. The clamped point is only approximately the closest point
+// of the box on the sphere; its distance d exceeds the true one by a relative error below 0.2 (d / R)^2 at mid latitudes,
+// so it is lowered by (d / R)^2, which leaves nearby boxes practically unchanged.
+double PackedRTree::getBoxDistance(const Coordinates &point, uint32_t box) const
+{
+    const int32_t latitude = std::clamp(point.getFixedLatitude(), mMinLatitudes[box], mMaxLatitudes[box]);
+    const int32_t longitude = std::clamp(point.getFixedLongitude(), mMinLongitudes[box], mMaxLongitudes[box]);
+    const double distance = HelperFunctions::haversine(point, Coordinates::fromFixedPoint(latitude, longitude));
+    const double angle = distance / (HelperFunctions::EARTH_RADIUS_KM * 1000.0);
+    return distance * (1.0 - angle * angle);
+}
+
+std::vector<ClosestEdges> PackedRTree::getClosestEdges(const Coordinates &point, uint8_t resultCount, bool multipleSegments) const
+{
+    SearchState state;
+    findClosestEdges(point, resultCount, multipleSegments, state, {});
+    return std::move(state.closestEdges);
+}
+
+void PackedRTree::findClosestEdges(const Coordinates &point, uint8_t resultCount, bool multipleSegments, SearchState &state, std::span<const ClosestEdges> hints) const
+{
+    // Starts with the same placeholder as the Quadtree, which remains at the end if there are fewer segments than requested
+    std::vector<ClosestEdges> &closestEdges = state.closestEdges;
+    closestEdges.clear();
+    closestEdges.emplace_back(ClosestEdges{std::numeric_limits<double>::max(), 0, 0});
+    if(mItems.empty())
+    {
+        return;
+    }
+
+    auto isFartherThanResults = [&](double distance)
+    {
+        return closestEdges.size() >= resultCount && distance >= closestEdges.back().distance;
+    };
+
+    auto addSegment = [&](Edge *edge, uint8_t subwayId)
+    {
+        const auto path = edge->getPath();
+        const double distance = HelperFunctions::distancePointToSegment(point, path[subwayId], path[subwayId + 1]);
+        if(isFartherThanResults(distance))
+        {
+            return;
+        }
+
+        // A hinted segment is found again by the search
+        auto it = std::find_if(closestEdges.begin(), closestEdges.end(), [&](const ClosestEdges &e)
+        {
+            return e.edge == edge && (!multipleSegments || e.subwayId == subwayId);
+        });
+        if(it != closestEdges.end())
+        {
+            if(distance >= it->distance) return;
+            closestEdges.erase(it);
+        }
+
+        auto insertPos = std::lower_bound(closestEdges.begin(), closestEdges.end(), distance, [](const ClosestEdges &e, double d) { return e.distance < d; });
+        closestEdges.emplace(insertPos, distance, edge, subwayId);
+        if(closestEdges.size() > resultCount) closestEdges.pop_back();
+    };
+
+    for(const ClosestEdges &hint : hints)
+    {
+        if(hint.edge != nullptr)
+        {
+            addSegment(hint.edge, hint.subwayId);
+        }
+    }
+
+    // Measures all segments of a leaf with the kernel; only those that can still make the results get the exact distance
+    const PlanarBound planarBound(point);
+    alignas(32) std::array<float, NODE_SIZE> squaredDistances;
+    auto addLeaf = [&](uint32_t leaf, uint32_t firstChild, uint32_t lastChild)
+    {
+        computeLeafDistances(point, leaf, planarBound.cosLatitude, squaredDistances.data());
+        for(uint32_t child = firstChild; child < lastChild; child++)
+        {
+            if(!isFartherThanResults(planarBound.getLowerBound(squaredDistances[child - firstChild])))
+            {
+                addSegment(mItems[child].edge, mItems[child].subwayId);
+            }
+        }
+    };
+
+    // Best-first search: nodes are expanded in order of their box distance until the nearest remaining one cannot improve the results
+    std::vector<std::pair<double, uint32_t>> &queue = state.queue;
+    queue.clear();
+    queue.emplace_back(0.0, mLevelOffsets[mLevelOffsets.size() - 2]);
+
+    const uint32_t itemCount = static_cast<uint32_t>(mItems.size());
+    while(!queue.empty())
+    {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<>());
+        const auto [distance, box] = queue.back();
+        queue.pop_back();
+        if(isFartherThanResults(distance))
+        {
+            break;
+        }
+
+        const uint32_t firstChild = mFirstChildren[box - itemCount];
+        const uint32_t levelEnd = *std::upper_bound(mLevelOffsets.begin(), mLevelOffsets.end(), firstChild);
+        const uint32_t lastChild = std::min(firstChild + NODE_SIZE, levelEnd);
+        if(firstChild < itemCount)
+        {
+            addLeaf(box, firstChild, lastChild);
+            continue;
+        }
+
+        for(uint32_t child = firstChild; child < lastChild; child++)
+        {
+            const double childDistance = getBoxDistance(point, child);
+            if(!isFartherThanResults(childDistance))
+            {
+                queue.emplace_back(childDistance, child);
+                std::push_heap(queue.begin(), queue.end(), std::greater<>());
+            }
+        }
+    }
+}
+
+std::vector<ClosestEdges> PackedRTree::withinRadius(const Coordinates &point, double radius, bool multipleSegments) const
+{
+    std::vector<ClosestEdges> closestEdges;
+    if(mItems.empty())
+    {
+        return closestEdges;
+    }
+
+    const PlanarBound planarBound(point);
+    alignas(32) std::array<float, NODE_SIZE> squaredDistances;
+
+    // Depth-first, since every node within the radius has to be visited anyway; the results are sorted once at the end
+    const uint32_t itemCount = static_cast<uint32_t>(mItems.size());
+    std::vector<uint32_t> stack{mLevelOffsets[mLevelOffsets.size() - 2]};
+    while(!stack.empty())
+    {
+        const uint32_t box = stack.back();
+        stack.pop_back();
+
+        const uint32_t firstChild = mFirstChildren[box - itemCount];
+        const uint32_t levelEnd = *std::upper_bound(mLevelOffsets.begin(), mLevelOffsets.end(), firstChild);
+        const uint32_t lastChild = std::min(firstChild + NODE_SIZE, levelEnd);
+        if(firstChild < itemCount)
+        {
+            computeLeafDistances(point, box, planarBound.cosLatitude, squaredDistances.data());
+            for(uint32_t child = firstChild; child < lastChild; child++)
+            {
+                if(planarBound.getLowerBound(squaredDistances[child - firstChild]) > radius)
+                {
+                    continue;
+                }
+
+                const Item &item = mItems[child];
+                const auto path = item.edge->getPath();
+                const double distance = HelperFunctions::distancePointToSegment(point, path[item.subwayId], path[item.subwayId + 1]);
+                if(distance <= radius)
+                {
+                    closestEdges.emplace_back(distance, item.edge, item.subwayId);
+                }
+            }
+            continue;
+        }
+
+        for(uint32_t child = firstChild; child < lastChild; child++)
+        {
+            if(getBoxDistance(point, child) <= radius)
+            {
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Keeps the closest segment of every edge
+    if(!multipleSegments)
+    {
+        std::sort(closestEdges.begin(), closestEdges.end(), [](const ClosestEdges &a, const ClosestEdges &b)
+        {
+            return a.edge != b.edge ? std::less<const Edge *>()(a.edge, b.edge) : a.distance < b.distance;
+        });
+        closestEdges.erase(std::unique(closestEdges.begin(), closestEdges.end(), [](const ClosestEdges &a, const ClosestEdges &b) { return a.edge == b.edge; }),
+                           closestEdges.end());
+    }
+
+    std::sort(closestEdges.begin(), closestEdges.end());
+    return closestEdges;
+}
+
+ClosestEdgesBatch PackedRTree::getClosestEdgesBatch(std::span<const Coordinates> points, uint8_t resultCount, bool multipleSegments, unsigned threadCount) const
+{
+    ClosestEdgesBatch batch;
+    batch.pointCount = static_cast<uint32_t>(points.size());
+    batch.resultCount = resultCount;
+    batch.results.assign(points.size() * resultCount, ClosestEdges{std::numeric_limits<double>::max(), nullptr, 0});
+    if(points.empty() || resultCount == 0)
+    {
+        return batch;
+    }
+
+    // Points in the order of their cells on a Hilbert curve over the bounding box of the tree
+    const int64_t minLatitude = mBoundary.getMinLatitudeLongitude().getFixedLatitude();
+    const int64_t minLongitude = mBoundary.getMinLatitudeLongitude().getFixedLongitude();
+    const int64_t latitudeRange = std::max<int64_t>(1, mBoundary.getMaxLatitudeLongitude().getFixedLatitude() - minLatitude);
+    const int64_t longitudeRange = std::max<int64_t>(1, mBoundary.getMaxLatitudeLongitude().getFixedLongitude() - minLongitude);
+    auto toCell = [](int64_t offset, int64_t range)
+    {
+        return static_cast<uint32_t>(std::clamp<int64_t>(offset * HILBERT_CELLS / range, 0, HILBERT_CELLS - 1));
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> order(points.size());
+    for(uint32_t point = 0; point < points.size(); point++)
+    {
+        const uint32_t x = toCell(points[point].getFixedLongitude() - minLongitude, longitudeRange);
+        const uint32_t y = toCell(points[point].getFixedLatitude() - minLatitude, latitudeRange);
+        order[point] = {getHilbertIndex(x, y), point};
+    }
+    std::sort(order.begin(), order.end());
+
+    const size_t chunkCount = (points.size() + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned>(threadCount, chunkCount);
+
+    // Workers take the next chunk from a shared counter; within a chunk every search is hinted with the results of the previous point
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&]()
+    {
+        SearchState state;
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+        {
+            const size_t begin = chunk * BATCH_CHUNK_SIZE;
+            const size_t end = std::min(begin + BATCH_CHUNK_SIZE, points.size());
+            for (size_t position = begin; position < end; position++)
+            {
+                const uint32_t point = order[position].second;
+                const std::span<const ClosestEdges> hints = position > begin ? batch.getClosestEdges(order[position - 1].second) : std::span<const ClosestEdges>();
+                findClosestEdges(points[point], resultCount, multipleSegments, state, hints);
+
+                const size_t count = std::min<size_t>(state.closestEdges.size(), resultCount);
+                std::copy_n(state.closestEdges.begin(), count, batch.results.begin() + static_cast<size_t>(point) * resultCount);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    return batch;
+}
@@ -1,16 +1,63 @@
 #include "parameters.hpp"
 
+#include <algorithm>
+
+Parameters::Parameters(std::vector<Tag> tags)
+{
+    // Stable sort keeps repeated keys in their order, so the last one can be picked
+    std::stable_sort(tags.begin(), tags.end(), [](const Tag &a, const Tag &b) { return a.key < b.key; });
+
+    std::vector<Tag> uniqueTags;
+    uniqueTags.reserve(tags.size());
+    for(const Tag &tag : tags)
+    {
+        if(!uniqueTags.empty() && uniqueTags.back().key == tag.key)
+        {
+            uniqueTags.back() = tag;
+        }
+        else
+        {
+            uniqueTags.push_back(tag);
+        }
+    }
+
+    mTagSetId = TagDictionary::getInstance().internTags(uniqueTags);
+}
+
 void Parameters::setParameter(const std::string &key, const std::string &value)
 {
-    parameters[key] = value;
+    TagDictionary &dictionary = TagDictionary::getInstance();
+    const Tag newTag{dictionary.intern(key), dictionary.intern(value)};
+
+    const std::span<const Tag> tags = getTags();
+    std::vector<Tag> newTags;
+    newTags.reserve(tags.size() + 1);
+
+    auto it = std::lower_bound(tags.begin(), tags.end(), newTag.key, [](const Tag &tag, uint32_t key) { return tag.key < key; });
+    newTags.insert(newTags.end(), tags.begin(), it);
+    newTags.push_back(newTag);
+    if(it != tags.end() && it->key == newTag.key)
+    {
+        ++it;
+    }
+    newTags.insert(newTags.end(), it, tags.end());
+
+    mTagSetId = dictionary.internTags(newTags);
 }
 
 std::string Parameters::getParameter(const std::string &key) const
 {
-    auto it = parameters.find(key);
-    if(it != parameters.end())
+    const uint32_t keyId = TagDictionary::getInstance().find(key);
+    if(keyId == TagDictionary::INVALID_ID)
+    {
+        return "";
+    }
+
+    const std::span<const Tag> tags = getTags();
+    auto it = std::lower_bound(tags.begin(), tags.end(), keyId, [](const Tag &tag, uint32_t key) { return tag.key < key; });
+    if(it != tags.end() && it->key == keyId)
     {
-        return it->second;
+        return std::string(TagDictionary::getInstance().getString(it->value));
     }
     return "";
 }
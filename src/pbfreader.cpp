@@ -0,0 +1,440 @@
+#include "pbfreader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include <zlib.h>
+
+namespace
+{
+    // Blob headers and blobs are limited by the format specification
+    constexpr uint32_t MAX_BLOB_HEADER_SIZE = 64 * 1024;
+    constexpr uint32_t MAX_BLOB_SIZE = 32 * 1024 * 1024;
+
+    // Blobs decoded per thread before the blocks are handed to the consumer; bounds the memory held at once
+    constexpr size_t BLOBS_PER_THREAD = 4;
+
+    // Minimal protobuf wire format reader over one message
+    class ProtoReader
+    {
+        public:
+            explicit ProtoReader(std::string_view data)
+                : mPosition(reinterpret_cast<const uint8_t *>(data.data())), mEnd(mPosition + data.size()) {}
+
+            bool atEnd() const { return mPosition >= mEnd; }
+
+            // Advances to the next field; false at the end of the message
+            bool next()
+            {
+                if(atEnd()) return false;
+                const uint64_t key = varint();
+                mField = static_cast<uint32_t>(key >> 3);
+                mWireType = static_cast<uint32_t>(key & 7);
+                return true;
+            }
+
+            uint32_t field() const { return mField; }
+            uint32_t wireType() const { return mWireType; }
+
+            uint64_t varint()
+            {
+                uint64_t value = 0;
+                for(uint32_t shift = 0; shift < 64; shift += 7)
+                {
+                    if(atEnd()) throw std::runtime_error("Truncated varint in PBF data");
+                    const uint8_t byte = *mPosition++;
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if(!(byte & 0x80)) return value;
+                }
+                throw std::runtime_error("Invalid varint in PBF data");
+            }
+
+            int64_t svarint()
+            {
+                const uint64_t value = varint();
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            std::string_view bytes()
+            {
+                const uint64_t size = varint();
+                if(size > static_cast<uint64_t>(mEnd - mPosition)) throw std::runtime_error("Truncated field in PBF data");
+                std::string_view view(reinterpret_cast<const char *>(mPosition), size);
+                mPosition += size;
+                return view;
+            }
+
+            void skip()
+            {
+                switch(mWireType)
+                {
+                    case 0: varint(); break;
+                    case 1: advance(8); break;
+                    case 2: bytes(); break;
+                    case 5: advance(4); break;
+                    default: throw std::runtime_error("Unsupported wire type " + std::to_string(mWireType) + " in PBF data");
+                }
+            }
+
+            // Repeated scalar field; accepts packed and unpacked encoding
+            template <typename Visitor>
+            void repeated(bool zigzag, Visitor &&visitor)
+            {
+                if(mWireType != 2)
+                {
+                    visitor(zigzag ? svarint() : static_cast<int64_t>(varint()));
+                    return;
+                }
+                ProtoReader packed(bytes());
+                while(!packed.atEnd())
+                {
+                    visitor(zigzag ? packed.svarint() : static_cast<int64_t>(packed.varint()));
+                }
+            }
+
+        private:
+            const uint8_t *mPosition;
+            const uint8_t *mEnd;
+            uint32_t mField = 0;
+            uint32_t mWireType = 0;
+
+            void advance(size_t size)
+            {
+                if(size > static_cast<size_t>(mEnd - mPosition)) throw std::runtime_error("Truncated field in PBF data");
+                mPosition += size;
+            }
+    };
+
+    uint32_t readBigEndian(const unsigned char *bytes)
+    {
+        return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+    }
+}
+
+PbfReader::PbfReader(const std::string &filepath, std::vector<std::string> wayKeys, OsmBlock::Content content)
+    : mFile(filepath, std::ios::binary), mFilepath(filepath), mWayKeys(std::move(wayKeys)), mContent(content)
+{
+    if(!mFile.is_open())
+    {
+        throw std::runtime_error("Error reading PBF file: " + filepath);
+    }
+}
+
+bool PbfReader::readBlob(std::string &type, RawBlob &blob)
+{
+    unsigned char sizeBytes[4];
+    if(!mFile.read(reinterpret_cast<char *>(sizeBytes), sizeof(sizeBytes)))
+    {
+        return false;
+    }
+
+    const uint32_t headerSize = readBigEndian(sizeBytes);
+    if(headerSize > MAX_BLOB_HEADER_SIZE)
+    {
+        throw std::runtime_error("Invalid blob header in PBF file: " + mFilepath);
+    }
+
+    std::string header(headerSize, '\0');
+    if(!mFile.read(header.data(), headerSize))
+    {
+        throw std::runtime_error("Truncated PBF file: " + mFilepath);
+    }
+
+    type.clear();
+    uint64_t dataSize = 0;
+    ProtoReader headerReader(header);
+    while(headerReader.next())
+    {
+        if(headerReader.field() == 1) type = headerReader.bytes();
+        else if(headerReader.field() == 3) dataSize = headerReader.varint();
+        else headerReader.skip();
+    }
+
+    if(dataSize > MAX_BLOB_SIZE)
+    {
+        throw std::runtime_error("Invalid blob size in PBF file: " + mFilepath);
+    }
+
+    std::string data(dataSize, '\0');
+    if(!mFile.read(data.data(), dataSize))
+    {
+        throw std::runtime_error("Truncated PBF file: " + mFilepath);
+    }
+
+    blob = RawBlob{};
+    ProtoReader blobReader(data);
+    while(blobReader.next())
+    {
+        switch(blobReader.field())
+        {
+            case 1:
+                blob.data = blobReader.bytes();
+                break;
+            case 2:
+                blob.rawSize = static_cast<uint32_t>(blobReader.varint());
+                break;
+            case 3:
+                blob.data = blobReader.bytes();
+                blob.compressed = true;
+                break;
+            case 4:
+            case 5:
+            case 6:
+            case 7:
+                throw std::runtime_error("Unsupported blob compression in PBF file: " + mFilepath);
+            default:
+                blobReader.skip();
+        }
+    }
+    return true;
+}
+
+std::string PbfReader::inflate(const RawBlob &blob) const
+{
+    if(!blob.compressed)
+    {
+        return blob.data;
+    }
+    if(blob.rawSize > MAX_BLOB_SIZE)
+    {
+        throw std::runtime_error("Invalid blob size in PBF file: " + mFilepath);
+    }
+
+    std::string data(blob.rawSize, '\0');
+    uLongf size = blob.rawSize;
+    if(uncompress(reinterpret_cast<Bytef *>(data.data()), &size, reinterpret_cast<const Bytef *>(blob.data.data()), blob.data.size()) != Z_OK
+        || size != blob.rawSize)
+    {
+        throw std::runtime_error("Corrupt zlib data in PBF file: " + mFilepath);
+    }
+    return data;
+}
+
+void PbfReader::checkHeader(const std::string &data) const
+{
+    // HeaderBlock: required_features = 4
+    ProtoReader reader(data);
+    while(reader.next())
+    {
+        if(reader.field() != 4)
+        {
+            reader.skip();
+            continue;
+        }
+
+        const std::string_view feature = reader.bytes();
+        if(feature != "OsmSchema-V0.6" && feature != "DenseNodes")
+        {
+            throw std::runtime_error("Unsupported PBF feature " + std::string(feature) + " in " + mFilepath);
+        }
+    }
+}
+
+OsmBlock PbfReader::decodeBlock(const std::string &data) const
+{
+    // PrimitiveBlock: stringtable = 1, primitivegroup = 2, granularity = 17, lat_offset = 19, lon_offset = 20
+    std::vector<std::string_view> strings;
+    std::vector<std::string_view> groups;
+    int64_t granularity = 100;
+    int64_t latOffset = 0;
+    int64_t lonOffset = 0;
+
+    ProtoReader blockReader(data);
+    while(blockReader.next())
+    {
+        switch(blockReader.field())
+        {
+            case 1:
+            {
+                ProtoReader tableReader(blockReader.bytes());
+                while(tableReader.next())
+                {
+                    if(tableReader.field() == 1) strings.push_back(tableReader.bytes());
+                    else tableReader.skip();
+                }
+                break;
+            }
+            case 2: groups.push_back(blockReader.bytes()); break;
+            case 17: granularity = static_cast<int64_t>(blockReader.varint()); break;
+            case 19: latOffset = static_cast<int64_t>(blockReader.varint()); break;
+            case 20: lonOffset = static_cast<int64_t>(blockReader.varint()); break;
+            default: blockReader.skip();
+        }
+    }
+
+    // Exact integer nanodegrees divided once, so coordinates come out like the decimal strings of the XML format
+    auto toDegrees = [&](int64_t offset, int64_t value) { return static_cast<double>(offset + granularity * value) / 1e9; };
+
+    std::vector<uint8_t> keptStrings(strings.size(), 0);
+    for(size_t index = 0; index < strings.size(); index++)
+    {
+        keptStrings[index] = std::find(mWayKeys.begin(), mWayKeys.end(), strings[index]) != mWayKeys.end();
+    }
+    auto getString = [&](int64_t index) -> std::string_view
+    {
+        if(index < 0 || static_cast<size_t>(index) >= strings.size()) throw std::runtime_error("Invalid string index in PBF file: " + mFilepath);
+        return strings[index];
+    };
+
+    OsmBlock block;
+    for(std::string_view group : groups)
+    {
+        // PrimitiveGroup: nodes = 1, dense = 2, ways = 3; relations and changesets are not needed
+        ProtoReader groupReader(group);
+        while(groupReader.next())
+        {
+            const bool wanted = (groupReader.field() == 3 ? mContent & OsmBlock::WAYS : mContent & OsmBlock::NODES) != 0;
+            if(!wanted)
+            {
+                groupReader.skip();
+            }
+            else if(groupReader.field() == 1)
+            {
+                // Node: id = 1, lat = 8, lon = 9 (sint64)
+                int64_t id = 0, lat = 0, lon = 0;
+                ProtoReader nodeReader(groupReader.bytes());
+                while(nodeReader.next())
+                {
+                    if(nodeReader.field() == 1) id = nodeReader.svarint();
+                    else if(nodeReader.field() == 8) lat = nodeReader.svarint();
+                    else if(nodeReader.field() == 9) lon = nodeReader.svarint();
+                    else nodeReader.skip();
+                }
+                block.nodes.push_back({static_cast<uint64_t>(id), toDegrees(latOffset, lat), toDegrees(lonOffset, lon)});
+            }
+            else if(groupReader.field() == 2)
+            {
+                // DenseNodes: delta coded id = 1, lat = 8, lon = 9
+                std::vector<int64_t> ids, lats, lons;
+                ProtoReader denseReader(groupReader.bytes());
+                while(denseReader.next())
+                {
+                    if(denseReader.field() == 1) denseReader.repeated(true, [&](int64_t value) { ids.push_back(value); });
+                    else if(denseReader.field() == 8) denseReader.repeated(true, [&](int64_t value) { lats.push_back(value); });
+                    else if(denseReader.field() == 9) denseReader.repeated(true, [&](int64_t value) { lons.push_back(value); });
+                    else denseReader.skip();
+                }
+                if(lats.size() != ids.size() || lons.size() != ids.size())
+                {
+                    throw std::runtime_error("Inconsistent dense nodes in PBF file: " + mFilepath);
+                }
+
+                int64_t id = 0, lat = 0, lon = 0;
+                block.nodes.reserve(block.nodes.size() + ids.size());
+                for(size_t index = 0; index < ids.size(); index++)
+                {
+                    id += ids[index];
+                    lat += lats[index];
+                    lon += lons[index];
+                    block.nodes.push_back({static_cast<uint64_t>(id), toDegrees(latOffset, lat), toDegrees(lonOffset, lon)});
+                }
+            }
+            else if(groupReader.field() == 3)
+            {
+                // Way: id = 1, keys = 2, vals = 3, delta coded refs = 8
+                OsmBlock::Way way{0, {}, {}};
+                std::vector<int64_t> keys, values;
+                ProtoReader wayReader(groupReader.bytes());
+                while(wayReader.next())
+                {
+                    if(wayReader.field() == 1) way.id = wayReader.varint();
+                    else if(wayReader.field() == 2) wayReader.repeated(false, [&](int64_t value) { keys.push_back(value); });
+                    else if(wayReader.field() == 3) wayReader.repeated(false, [&](int64_t value) { values.push_back(value); });
+                    else if(wayReader.field() == 8)
+                    {
+                        int64_t ref = 0;
+                        wayReader.repeated(true, [&](int64_t delta) { ref += delta; way.nodeRefs.push_back(static_cast<uint64_t>(ref)); });
+                    }
+                    else wayReader.skip();
+                }
+                if(keys.size() != values.size())
+                {
+                    throw std::runtime_error("Inconsistent way tags in PBF file: " + mFilepath);
+                }
+
+                for(size_t index = 0; index < keys.size(); index++)
+                {
+                    if(keys[index] >= 0 && static_cast<size_t>(keys[index]) < keptStrings.size() && keptStrings[keys[index]])
+                    {
+                        way.tags.emplace_back(getString(keys[index]), getString(values[index]));
+                    }
+                }
+                block.ways.push_back(std::move(way));
+            }
+            else
+            {
+                groupReader.skip();
+            }
+        }
+    }
+    return block;
+}
+
+void PbfReader::read(const std::function<void(OsmBlock &&)> &consumer, unsigned threadCount)
+{
+    if(threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    std::string type;
+    RawBlob blob;
+    bool endOfFile = false;
+    while(!endOfFile)
+    {
+        // Read a batch of data blobs sequentially, decode it in parallel, hand the blocks out in file order
+        std::vector<RawBlob> batch;
+        while(batch.size() < threadCount * BLOBS_PER_THREAD)
+        {
+            if(!readBlob(type, blob))
+            {
+                endOfFile = true;
+                break;
+            }
+
+            if(type == "OSMHeader") checkHeader(inflate(blob));
+            else if(type == "OSMData") batch.push_back(std::move(blob));
+        }
+
+        std::vector<OsmBlock> blocks(batch.size());
+        std::vector<std::exception_ptr> errors(threadCount);
+        std::atomic<size_t> nextBlob{0};
+        auto worker = [&](unsigned thread)
+        {
+            try
+            {
+                for(size_t index = nextBlob++; index < batch.size(); index = nextBlob++)
+                {
+                    blocks[index] = decodeBlock(inflate(batch[index]));
+                    batch[index] = RawBlob{};
+                }
+            }
+            catch(...)
+            {
+                errors[thread] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(unsigned thread = 1; thread < std::min<size_t>(threadCount, batch.size()); thread++)
+        {
+            threads.emplace_back(worker, thread);
+        }
+        worker(0);
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for(const auto &error : errors)
+        {
+            if(error) std::rethrow_exception(error);
+        }
+
+        for(OsmBlock &block : blocks)
+        {
+            consumer(std::move(block));
+        }
+    }
+}
@@ -58,79 +58,68 @@ void Quadtree::insert(Edge *edge, uint8_t subwayId)
 {
     const Box edgeBox = edge->getBoundingBox(subwayId);
 
-    if (!mBoundary.contains(edgeBox))
+    if (!mBoundary.overlaps(edgeBox))
     {
         return; // The edge does not belong in this quadtree node
     }
 
     /*
     Hat der Knoten Kinder?
-    Nein -> Item hier ablegen
-    Ja ->
-        Passt das Item vollständig in GENAU EIN Child?
-            Ja  -> dort einfügen
-            Nein -> Item hier behalten
+    Nein -> Item hier ablegen, bei zu vielen Items aufteilen
+    Ja -> in jedes Kind einfügen, dessen Zelle das Item überlappt
     */
     if(mNorthWest == nullptr)
     {
         mEdgeSubwayIDs.emplace_back(edge, subwayId);
 
-        if(mEdgeSubwayIDs.size() > MAX_ITEMS)
+        if(mEdgeSubwayIDs.size() > mSplitThreshold)
         {
             if(subdivide())
             {
                 // Alle Items neu verteilen
-                auto items = mEdgeSubwayIDs;
+                const auto items = std::move(mEdgeSubwayIDs);
                 mEdgeSubwayIDs.clear();
 
                 for(const auto &[eId, sId] : items)
                 {
-                    insert(eId, sId);
+                    insertIntoChildren(eId, sId);
                 }
             }
+            else
+            {
+                mSplitThreshold *= 2;
+            }
         }
     }
     else
     {
-        if(mNorthWest->getBoundary().contains(edgeBox))
-        {
-            mNorthWest->insert(edge, subwayId);
-            return;
-        }
-        if(mNorthEast->getBoundary().contains(edgeBox))
-        {
-            mNorthEast->insert(edge, subwayId);
-            return;
-        }
-        if(mSouthWest->getBoundary().contains(edgeBox))
-        {
-            mSouthWest->insert(edge, subwayId);
-            return;
-        }
-        if(mSouthEast->getBoundary().contains(edgeBox))
-        {
-            mSouthEast->insert(edge, subwayId);
-            return;
-        }
+        insertIntoChildren(edge, subwayId);
+    }
+}
 
-        // Passt in keines der Kinder, also hier behalten
-        mEdgeSubwayIDs.emplace_back(edge, subwayId);
+void Quadtree::insertIntoChildren(Edge *edge, uint8_t subwayId)
+{
+    for(Quadtree *child : {mNorthWest.get(), mNorthEast.get(), mSouthWest.get(), mSouthEast.get()})
+    {
+        child->insert(edge, subwayId);
     }
 }
 
-std::vector<ClosestEdges> Quadtree::getClosestEdges(const Coordinates &point, uint8_t resultCount, bool multipleSegments) const
+std::vector<ClosestEdges> Quadtree::getClosestEdges(const Coordinates &point, uint8_t resultCount, bool multipleSegments, uint32_t *visitedNodes) const
 {
     std::vector<ClosestEdges> closestEdges;
     closestEdges.emplace_back(ClosestEdges{std::numeric_limits<double>::max(), 0, 0});
 
-    findClosestEdges(point, resultCount, closestEdges, multipleSegments);
+    findClosestEdges(point, resultCount, closestEdges, multipleSegments, visitedNodes);
 
     
     return closestEdges;
 }
 
-void Quadtree::findClosestEdges(const Coordinates &point, uint8_t resultCount, std::vector<ClosestEdges> &closestEdges, bool multipleSegments) const
+void Quadtree::findClosestEdges(const Coordinates &point, uint8_t resultCount, std::vector<ClosestEdges> &closestEdges, bool multipleSegments, uint32_t *visitedNodes) const
 {
+    if(visitedNodes) (*visitedNodes)++;
+
     for(const auto &[edge, subwayId] : mEdgeSubwayIDs)
     {
         // Early skip if bounding box distance is already larger than the farthest closest edge found
@@ -143,7 +132,12 @@ void Quadtree::findClosestEdges(const Coordinates &point, uint8_t resultCount, s
 
         if(distance >= closestEdges.back().distance && closestEdges.size() >= resultCount) continue;
 
-        if(!multipleSegments)
+        // A segment crossing a cell border is stored in every leaf it overlaps, so it may already be among the results
+        if(multipleSegments)
+        {
+            if(std::any_of(closestEdges.begin(), closestEdges.end(), [&](const ClosestEdges& e) { return e.edge == edge && e.subwayId == subwayId; })) continue;
+        }
+        else
         {
             auto it = std::find_if(closestEdges.begin(), closestEdges.end(), [&](const ClosestEdges& e) { return e.edge == edge; });
 
@@ -160,27 +154,28 @@ void Quadtree::findClosestEdges(const Coordinates &point, uint8_t resultCount, s
         if(closestEdges.size() > resultCount) closestEdges.pop_back();
     }
 
-    // Recurse into children
-    std::array<std::pair<double, Quadtree *>, 4> children = {{
-        {(mNorthWest != nullptr) ? mNorthWest->getBoundary().getDistance(point) : std::numeric_limits<double>::max(), mNorthWest.get()},
-        {(mNorthEast != nullptr) ? mNorthEast->getBoundary().getDistance(point) : std::numeric_limits<double>::max(), mNorthEast.get()},
-        {(mSouthWest != nullptr) ? mSouthWest->getBoundary().getDistance(point) : std::numeric_limits<double>::max(), mSouthWest.get()},
-        {(mSouthEast != nullptr) ? mSouthEast->getBoundary().getDistance(point) : std::numeric_limits<double>::max(), mSouthEast.get()} }};
+    if(mNorthWest == nullptr)
+    {
+        return;
+    }
 
-    std::sort(children.begin(), children.end(),
-              [](const std::pair<double, Quadtree *> &a, const std::pair<double, Quadtree *> &b)
-              {
-                  return a.first < b.first;
-              });
+    // Recurse into children by distance, the closest first, as it tightens the bound for the others
+    std::array<std::pair<double, Quadtree *>, 4> children;
+    const std::array<Quadtree *, 4> subtrees = {mNorthWest.get(), mNorthEast.get(), mSouthWest.get(), mSouthEast.get()};
+    for(size_t index = 0; index < subtrees.size(); index++)
+    {
+        children[index] = {subtrees[index]->getBoundary().getDistance(point), subtrees[index]};
+    }
+    std::sort(children.begin(), children.end());
 
-    for(auto child : children)
+    for(const auto &[distance, child] : children)
     {
-        if(child.second == nullptr || child.first >= closestEdges.back().distance)
+        if(distance >= closestEdges.back().distance)
         {
             break;
         }
 
-        child.second->findClosestEdges(point, resultCount, closestEdges, multipleSegments);
+        child->findClosestEdges(point, resultCount, closestEdges, multipleSegments, visitedNodes);
     }
 }
 
@@ -212,5 +207,25 @@ bool Quadtree::subdivide()
     mSouthWest = std::make_unique<Quadtree>(mGraph, Box(mBoundary.getLeftMiddle(), mBoundary.getBottomMiddle()), mLevel + 1);
     mSouthEast = std::make_unique<Quadtree>(mGraph, Box(mBoundary.getCenter(), mBoundary.getBottomRight()), mLevel + 1);
 
+    // Adaptive depth: only split while segments crossing the new cell borders add at most a quarter more copies,
+    // so long segments are not copied into ever more leaves
+    size_t copyCount = 0;
+    for(const auto &[edge, subwayId] : mEdgeSubwayIDs)
+    {
+        const Box edgeBox = edge->getBoundingBox(subwayId);
+        for(Quadtree *child : {mNorthWest.get(), mNorthEast.get(), mSouthWest.get(), mSouthEast.get()})
+        {
+            copyCount += child->getBoundary().overlaps(edgeBox);
+        }
+    }
+    if(copyCount * 4 > mEdgeSubwayIDs.size() * 5)
+    {
+        mNorthWest.reset();
+        mNorthEast.reset();
+        mSouthWest.reset();
+        mSouthEast.reset();
+        return false;
+    }
+
     return true;
 }
@@ -2,65 +2,427 @@
 
 #include <ankerl/unordered_dense.h>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
 
 #include "library.hpp"
 #include "weights.hpp"
 
-Router::Router(const std::string &osmFile, const std::string &weightCSVFile)
+Router::Router(const std::string &osmFile, const std::string &weightCSVFile, const IngestFilter &filter) : mOsmFile(osmFile)
 {
-    ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> nodes;
-    ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> ways;
-
     mGraph = std::make_unique<Graph>();
+    // Load the weights before the graph, so a missing file fails fast
+    std::unique_ptr<Weights> weights;
     if(!weightCSVFile.empty())
     {
-        mWeights = std::make_unique<Weights>(weightCSVFile);
+        weights = std::make_unique<Weights>(weightCSVFile);
+    }
+
+    if(GraphSnapshot::isSnapshot(osmFile))
+    {
+        const GraphSnapshot snapshot(osmFile);
+        snapshot.createGraph(*mGraph);
+
+        mCsrGraph = std::make_unique<CsrGraph>(*mGraph);
+        mRTree = std::make_unique<PackedRTree>(*mGraph, snapshot);
+        mBoundary = snapshot.getBoundary();
+    }
+    else
+    {
+        mBoundary = HelperFunctions::readOSMGraph(osmFile, *mGraph, filter);
+
+        mCsrGraph = std::make_unique<CsrGraph>(*mGraph);
+        mRTree = std::make_unique<PackedRTree>(*mGraph);
+    }
+
+    mDistanceProfile = &registerProfile(DISTANCE_PROFILE, nullptr);
+    if(weights)
+    {
+        mDefaultProfile = &registerProfile(DEFAULT_PROFILE, std::move(weights));
+    }
+}
+
+Quadtree &Router::getQuadtree()
+{
+    if(!mQuadtree)
+    {
+        mQuadtree = std::make_unique<Quadtree>(*mGraph, mBoundary);
+    }
+    return *mQuadtree;
+}
+
+const CompiledProfile &Router::addProfile(const std::string &name, const std::string &weightCSVFile)
+{
+    if(name == DISTANCE_PROFILE)
+    {
+        throw std::invalid_argument("Profile name is reserved: " + name);
+    }
+
+    Profile &profile = registerProfile(name, std::make_unique<Weights>(weightCSVFile));
+    if(name == DEFAULT_PROFILE)
+    {
+        mDefaultProfile = &profile;
+    }
+    return *profile.costs;
+}
+
+Router::Profile &Router::registerProfile(const std::string &name, std::unique_ptr<Weights> weights)
+{
+    if(hasProfile(name))
+    {
+        throw std::invalid_argument("Profile already exists: " + name);
+    }
+
+    auto profile = std::make_unique<Profile>();
+    profile->name = name;
+    profile->weights = std::move(weights);
+    profile->costs = std::make_unique<CompiledProfile>(*mGraph, profile->weights.get());
+    if(profile->weights)
+    {
+        // Costs follow weight changes right away, so queries only read them
+        profile->weights->addChangeListener([costs = profile->costs.get()](const Tag &tag) { costs->updateTag(tag); });
+    }
+
+    mProfiles.push_back(std::move(profile));
+    return *mProfiles.back();
+}
+
+bool Router::hasProfile(const std::string &name) const
+{
+    return std::any_of(mProfiles.begin(), mProfiles.end(), [&](const auto &profile) { return profile->name == name; });
+}
+
+std::vector<std::string> Router::getProfileNames() const
+{
+    std::vector<std::string> names;
+    for(const auto &profile : mProfiles)
+    {
+        names.push_back(profile->name);
+    }
+    return names;
+}
+
+const Router::Profile &Router::findProfile(const std::string &name) const
+{
+    for(const auto &profile : mProfiles)
+    {
+        if(profile->name == name)
+        {
+            return *profile;
+        }
+    }
+    throw std::out_of_range("Unknown profile: " + name);
+}
+
+const Router::Profile &Router::getEntry(const CompiledProfile &profile) const
+{
+    for(const auto &entry : mProfiles)
+    {
+        if(entry->costs.get() == &profile)
+        {
+            return *entry;
+        }
+    }
+    throw std::invalid_argument("Profile does not belong to this router");
+}
+
+const Router::Profile &Router::getRoutingProfile(bool useWeighting) const
+{
+    if(useWeighting && !mDefaultProfile)
+    {
+        std::cerr << "Weighting enabled but no weights provided. Please provide a weight CSV file when initializing the Router.\n";
+    }
+    const Profile *profile = getBuiltinProfile(useWeighting);
+    return profile ? *profile : *mDistanceProfile;
+}
+
+std::string Router::getProfileFilename(const Profile &profile, const std::string &extension) const
+{
+    // The built-in profiles keep the file names they had before profiles could be named
+    if(&profile == mDistanceProfile)
+    {
+        return mOsmFile + extension;
+    }
+    if(profile.name == DEFAULT_PROFILE)
+    {
+        return mOsmFile + ".weighted" + extension;
+    }
+    return mOsmFile + "." + profile.name + extension;
+}
+
+void Router::updateEdgeCost(const Edge &edge)
+{
+    for(const auto &profile : mProfiles)
+    {
+        profile->costs->updateEdge(edge);
+    }
+}
+
+const Landmarks<float> *Router::getLandmarks(bool useWeighting) const
+{
+    const Profile *profile = getBuiltinProfile(useWeighting);
+    return profile ? profile->landmarks.get() : nullptr;
+}
+
+const ContractionHierarchy *Router::getContractionHierarchy(bool useWeighting) const
+{
+    const Profile *profile = getBuiltinProfile(useWeighting);
+    return profile ? profile->contractionHierarchy.get() : nullptr;
+}
+
+void Router::prepareContractionHierarchy(bool useWeighting)
+{
+    if(useWeighting && !mDefaultProfile)
+    {
+        std::cerr << "Weighting enabled but no weights provided. Please provide a weight CSV file when initializing the Router.\n";
+        return;
+    }
+    prepareContractionHierarchy(*getBuiltinProfile(useWeighting)->costs);
+}
+
+void Router::prepareContractionHierarchy(const CompiledProfile &compiledProfile)
+{
+    Profile &profile = getEntry(compiledProfile);
+    profile.contractionHierarchy = ContractionHierarchy::loadOrBuild(getProfileFilename(profile, ".ch"), *mGraph, *mCsrGraph, profile.weights.get());
+    profile.contractionHierarchyRevision = profile.getRevision();
+}
+
+void Router::customizeContractionHierarchy(bool useWeighting)
+{
+    if(useWeighting && !mDefaultProfile)
+    {
+        std::cerr << "Weighting enabled but no weights provided. Please provide a weight CSV file when initializing the Router.\n";
+        return;
+    }
+    customizeContractionHierarchy(*getBuiltinProfile(useWeighting)->costs);
+}
+
+void Router::customizeContractionHierarchy(const CompiledProfile &compiledProfile)
+{
+    Profile &profile = getEntry(compiledProfile);
+
+    // The contracted topology is shared by all profiles, only the customization is per profile
+    if(!mCustomizableContractionHierarchy)
+    {
+        mCustomizableContractionHierarchy = std::make_unique<CustomizableContractionHierarchy>(*mCsrGraph);
+    }
+
+    profile.contractionHierarchy = mCustomizableContractionHierarchy->customize(*mGraph, *mCsrGraph, profile.weights.get());
+    profile.contractionHierarchyRevision = profile.getRevision();
+}
+
+void Router::prepareLandmarks(uint32_t landmarkCount, bool useWeighting, LandmarkSelection selection)
+{
+    if(useWeighting && !mDefaultProfile)
+    {
+        std::cerr << "Weighting enabled but no weights provided. Please provide a weight CSV file when initializing the Router.\n";
+        return;
+    }
+    prepareLandmarks(*getBuiltinProfile(useWeighting)->costs, landmarkCount, selection);
+}
+
+void Router::prepareLandmarks(const CompiledProfile &compiledProfile, uint32_t landmarkCount, LandmarkSelection selection)
+{
+    Profile &profile = getEntry(compiledProfile);
+    profile.landmarks = std::make_unique<Landmarks<float>>(*mGraph, *mCsrGraph, profile.weights.get(), landmarkCount, selection);
+    profile.landmarksRevision = profile.getRevision();
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(uint64_t startId, uint64_t goalId, uint8_t snapToRoads, bool useWeighting, RoutingMode mode)
+{
+    return aStar(mSearchContext, startId, goalId, snapToRoads, useWeighting, mode);
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads, bool useWeighting, RoutingMode mode)
+{
+    return aStar(mSearchContext, startCoords, goalCoords, snapToRoads, useWeighting, mode);
+}
+
+std::vector<Edge *> Router::aStarEdges(uint64_t startId, uint64_t goalId, bool useWeighting, RoutingMode mode)
+{
+    return aStarEdges(mSearchContext, startId, goalId, useWeighting, mode);
+}
+
+std::vector<Edge *> Router::aStarEdges(Coordinates startCoords, Coordinates goalCoords, bool useWeighting, RoutingMode mode)
+{
+    return aStarEdges(mSearchContext, startCoords, goalCoords, useWeighting, mode);
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(SearchContext &context, uint64_t startId, uint64_t goalId, uint8_t snapToRoads, bool useWeighting, RoutingMode mode) const
+{
+    return aStar(context, startId, goalId, *getRoutingProfile(useWeighting).costs, snapToRoads, mode);
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads, bool useWeighting, RoutingMode mode) const
+{
+    return aStar(context, startCoords, goalCoords, *getRoutingProfile(useWeighting).costs, snapToRoads, mode);
+}
+
+std::vector<Edge *> Router::aStarEdges(SearchContext &context, uint64_t startId, uint64_t goalId, bool useWeighting, RoutingMode mode) const
+{
+    return aStarEdges(context, startId, goalId, *getRoutingProfile(useWeighting).costs, mode);
+}
+
+std::vector<Edge *> Router::aStarEdges(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, bool useWeighting, RoutingMode mode) const
+{
+    return aStarEdges(context, startCoords, goalCoords, *getRoutingProfile(useWeighting).costs, mode);
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(SearchContext &context, uint64_t startId, uint64_t goalId, const CompiledProfile &profile, uint8_t snapToRoads, RoutingMode mode) const
+{
+    prepareOverlay(context);
+    const uint32_t startIndex = mGraph->getNodeIndex(startId);
+    const uint32_t goalIndex = mGraph->getNodeIndex(goalId);
+
+    route(context, startIndex, goalIndex, snapToRoads, getEntry(profile), mode);
+
+    auto path = reconstructPath(context, startIndex, goalIndex);
+    if (path.empty())
+    {
+        std::cerr << "No path found from " << startId << " to " << goalId << "\n";
+    }
+    return path;
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, const CompiledProfile &profile, uint8_t snapToRoads, RoutingMode mode) const
+{
+    prepareOverlay(context);
+    const uint32_t startIndex = addPhantomNode(context, startCoords);
+    const uint32_t goalIndex = addPhantomNode(context, goalCoords);
+
+    route(context, startIndex, goalIndex, snapToRoads, getEntry(profile), mode);
+
+    auto path = reconstructPath(context, startIndex, goalIndex);
+    if (path.empty())
+    {
+        std::cerr << "No path found from " << startCoords << " to " << goalCoords << "\n";
+    }
+    return path;
+}
+
+std::vector<Edge *> Router::aStarEdges(SearchContext &context, uint64_t startId, uint64_t goalId, const CompiledProfile &profile, RoutingMode mode) const
+{
+    prepareOverlay(context);
+    const uint32_t startIndex = mGraph->getNodeIndex(startId);
+    const uint32_t goalIndex = mGraph->getNodeIndex(goalId);
+
+    route(context, startIndex, goalIndex, 1, getEntry(profile), mode);
+
+    if (!context.isReached(goalIndex))
+    {
+        std::cerr << "No path found from " << startId << " to " << goalId << "\n";
+        return {};
+    }
+    return reconstructEdges(context, startIndex, goalIndex);
+}
+
+std::vector<Edge *> Router::aStarEdges(SearchContext &context, Coordinates startCoords, Coordinates goalCoords, const CompiledProfile &profile, RoutingMode mode) const
+{
+    prepareOverlay(context);
+    const uint32_t startIndex = addPhantomNode(context, startCoords);
+    const uint32_t goalIndex = addPhantomNode(context, goalCoords);
+
+    route(context, startIndex, goalIndex, 1, getEntry(profile), mode);
+
+    if (!context.isReached(goalIndex))
+    {
+        std::cerr << "No path found from " << startCoords << " to " << goalCoords << "\n";
+        return {};
     }
-    HelperFunctions::readOSMFile(osmFile, nodes, ways);
-    Box boundary = HelperFunctions::createGraph(*mGraph, nodes, ways);
+    return reconstructEdges(context, startIndex, goalIndex);
+}
+
+void Router::prepareOverlay(SearchContext &context) const
+{
+    CsrGraph::Overlay &overlay = context.getOverlay();
 
-    mQuadtree = std::make_unique<Quadtree>(*mGraph, boundary);
+    // Split items live in the mutable Graph only; they are routed through the overlay on top of the CSR arrays
+    if (mGraph->getSplitItemIds().empty())
+    {
+        overlay.clear();
+        overlay.phantomBase = mGraph->getNodeCount();
+    }
+    else
+    {
+        mCsrGraph->buildOverlay(*mGraph, overlay);
+    }
 }
 
-std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(uint64_t startId, uint64_t goalId, uint8_t snapToRoads, bool useWeighting)
+uint32_t Router::addPhantomNode(SearchContext &context, const Coordinates &coords) const
 {
-    aStarRouting(startId, goalId, snapToRoads, useWeighting);
+    const ClosestEdges closestEdge = mRTree->getClosestEdges(coords)[0];
+    return mCsrGraph->addPhantomNode(*mGraph, context.getOverlay(), coords, closestEdge.edge->getIndex(), closestEdge.subwayId);
+}
+
+Coordinates Router::getNodeCoordinates(const SearchContext &context, uint32_t nodeIndex) const
+{
+    if (nodeIndex < mCsrGraph->getNodeCount())
+    {
+        return mCsrGraph->getCoordinates(nodeIndex);
+    }
+    if (nodeIndex < mGraph->getNodeCount())
+    {
+        return mGraph->getNodeByIndex(nodeIndex)->getCoordinates();
+    }
+    return context.getOverlay().getPhantomNode(nodeIndex).coordinates;
+}
+
+std::vector<std::tuple<uint64_t, Coordinates>> Router::reconstructPath(const SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const
+{
+    const CsrGraph::Overlay &overlay = context.getOverlay();
+
+    // Position of a node along the polyline of an edge: vertex index for end nodes, between two vertices for phantom nodes
+    auto positionOnEdge = [&](uint32_t nodeIndex, uint32_t edgeIndex, bool atEnd, size_t vertexCount) -> double
+    {
+        if (overlay.isPhantom(nodeIndex) && overlay.getPhantomNode(nodeIndex).edge == edgeIndex)
+        {
+            return overlay.getPhantomNode(nodeIndex).segmentIndex + 0.5;
+        }
+        return atEnd ? static_cast<double>(vertexCount - 1) : 0.0;
+    };
 
     // Pfad rekonstruieren
     std::vector<std::tuple<uint64_t, Coordinates>> path;
-    for (uint64_t nodeId = goalId;; nodeId = mGraph->getNodes().at(nodeId)->parent)
+    for (uint32_t nodeIndex = goalIndex;; nodeIndex = context.getParent(nodeIndex))
     {
-        if (nodeId == 0)
+        if (nodeIndex == SearchContext::INVALID_INDEX)
         {
-            std::cerr << "No path found from " << startId << " to " << goalId << "\n";
             return std::vector<std::tuple<uint64_t, Coordinates>>(); // Kein Pfad gefunden
         }
-        const Node &currentNode = *mGraph->getNodes().at(nodeId);
-        path.emplace_back(nodeId, currentNode.getCoordinates());
 
-        if (nodeId == startId)
+        const uint64_t nodeId = nodeIndex < mGraph->getNodeCount() ? mGraph->getNodeByIndex(nodeIndex)->getId() : 0;
+        path.emplace_back(nodeId, getNodeCoordinates(context, nodeIndex));
+
+        if (nodeIndex == startIndex)
             break;
 
-        const Edge *edge = currentNode.parentEdge;
-        if (edge == nullptr)
+        const uint32_t edgeIndex = context.getParentEdge(nodeIndex);
+        if (edgeIndex == SearchContext::INVALID_INDEX)
             continue;
 
-        const auto &edgePath = edge->getPath();
+        const auto &edgePath = mGraph->getEdgeByIndex(edgeIndex)->getPath();
         if (edgePath.size() <= 2)
             continue;
 
-        if (!currentNode.parentEdgeReversed)
+        // Forward arcs run from lower to higher positions; add the vertices in between, starting on this node's side
+        const bool reversed = context.isParentEdgeReversed(nodeIndex);
+        const double nodePosition = positionOnEdge(nodeIndex, edgeIndex, !reversed, edgePath.size());
+        const double parentPosition = positionOnEdge(context.getParent(nodeIndex), edgeIndex, reversed, edgePath.size());
+
+        if (nodePosition > parentPosition)
         {
-            for (size_t pathIndex = edgePath.size() - 2; pathIndex > 0; --pathIndex)
+            for (double pathIndex = std::ceil(nodePosition) - 1; pathIndex > parentPosition; --pathIndex)
             {
-                path.emplace_back(0, edgePath.at(pathIndex));
+                path.emplace_back(0, edgePath[static_cast<size_t>(pathIndex)]);
             }
         }
         else
         {
-            for (size_t pathIndex = 1; pathIndex < edgePath.size() - 1; ++pathIndex)
+            for (double pathIndex = std::floor(nodePosition) + 1; pathIndex < parentPosition; ++pathIndex)
             {
-                path.emplace_back(0, edgePath.at(pathIndex));
+                path.emplace_back(0, edgePath[static_cast<size_t>(pathIndex)]);
             }
         }
     }
@@ -69,30 +431,25 @@ std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(uint64_t startId, u
     return path;
 }
 
-std::vector<Edge *> Router::aStarEdges(uint64_t startId, uint64_t goalId, bool useWeighting)
+std::vector<Edge *> Router::reconstructEdges(const SearchContext &context, uint32_t startIndex, uint32_t goalIndex) const
 {
-    aStarRouting(startId, goalId, 1, useWeighting);
-
     // Pfad rekonstruieren
     std::vector<Edge *> path;
 
-    for (uint64_t nodeId = goalId;; nodeId = mGraph->getNodes().at(nodeId)->parent)
+    for (uint32_t nodeIndex = goalIndex;; nodeIndex = context.getParent(nodeIndex))
     {
-        if (nodeId == 0)
+        if (nodeIndex == SearchContext::INVALID_INDEX)
         {
-            std::cerr << "No path found from " << startId << " to " << goalId << "\n";
             return {};
         }
 
-        if (nodeId == startId)
+        if (nodeIndex == startIndex)
             break;
 
-        Node &currentNode = *mGraph->getNodes().at(nodeId);
-        Edge *edge = currentNode.parentEdge;
-
-        if (edge != nullptr)
+        const uint32_t edgeIndex = context.getParentEdge(nodeIndex);
+        if (edgeIndex != SearchContext::INVALID_INDEX)
         {
-            path.push_back(edge); 
+            path.push_back(mGraph->getEdgeByIndex(edgeIndex)); 
         }
     }
 
@@ -103,120 +460,445 @@ std::vector<Edge *> Router::aStarEdges(uint64_t startId, uint64_t goalId, bool u
     return path;
 }
 
-std::vector<Edge *> Router::aStarEdges(Coordinates startCoords, Coordinates goalCoords, bool useWeighting)
+template <typename Visitor>
+void Router::forEachArc(const SearchContext &context, uint32_t nodeIndex, Visitor &&visitor) const
+{
+    if (nodeIndex < mCsrGraph->getNodeCount())
+    {
+        for (const CsrGraph::Arc &arc : mCsrGraph->getArcs(nodeIndex))
+        {
+            visitor(arc, 1.0);
+        }
+    }
+
+    for (const auto &overlayArc : context.getOverlay().getArcs(nodeIndex))
+    {
+        visitor(overlayArc.arc, overlayArc.weightFactor);
+    }
+}
+
+void Router::route(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const Profile &profile, RoutingMode mode) const
+{
+    // Hierarchies and landmark tables keep their own costs; the searches read the compiled profile
+    if(mode == RoutingMode::ContractionHierarchy)
+    {
+        // The hierarchy only knows the CSR graph; split items in the Graph are not contracted
+        const ContractionHierarchy *hierarchy = profile.contractionHierarchy.get();
+        if(hierarchy && mGraph->getSplitItemIds().empty() && profile.contractionHierarchyRevision == profile.getRevision())
+        {
+            if(!hierarchy->query(context, startIndex, goalIndex))
+            {
+                context.startSearch(context.getOverlay().getNodeCount());
+            }
+            return;
+        }
+        // A hierarchy contracted with older weights returns the shortest paths for those weights
+        std::cerr << (hierarchy && profile.contractionHierarchyRevision != profile.getRevision() ? "Weights changed since the contraction hierarchy was prepared, falling back to A*.\n"
+                                                                                               : "No contraction hierarchy prepared for this query, falling back to A*.\n");
+        aStarRouting(context, startIndex, goalIndex, snapToRoads, *profile.costs);
+    }
+    else if(mode == RoutingMode::ALT)
+    {
+        landmarkRouting(context, startIndex, goalIndex, snapToRoads, profile);
+    }
+    else if(mode == RoutingMode::BidirectionalAStar)
+    {
+        bidirectionalAStarRouting(context, startIndex, goalIndex, snapToRoads, *profile.costs);
+    }
+    else
+    {
+        aStarRouting(context, startIndex, goalIndex, snapToRoads, *profile.costs);
+    }
+}
+
+template <typename Potential>
+void Router::aStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, const CompiledProfile &profile, Potential &&potential) const
 {
-    auto [closestStartPoint, closestStartEdgeId, startSegment] = getEdgeSplit(startCoords);
-    uint64_t newNodeIdStart = mGraph->addSplit(closestStartPoint, closestStartEdgeId, startSegment);
+    switch (mPriorityQueue)
+    {
+        case PriorityQueue::BinaryHeap:
+            aStarSearch<BinaryHeap>(context, startIndex, goalIndex, profile, potential);
+            break;
+        case PriorityQueue::QuaternaryHeap:
+            aStarSearch<QuaternaryHeap>(context, startIndex, goalIndex, profile, potential);
+            break;
+        case PriorityQueue::RadixHeap:
+            aStarSearch<RadixHeap>(context, startIndex, goalIndex, profile, potential);
+            break;
+    }
+}
 
-    auto [closestEndPoint, closestEndEdgeId, endSegment] = getEdgeSplit(goalCoords);
-    uint64_t newNodeIdEnd = mGraph->addSplit(closestEndPoint, closestEndEdgeId, endSegment);
+template <typename Queue, typename Potential>
+void Router::aStarSearch(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, const CompiledProfile &profile, Potential &&potential) const
+{
+    const uint32_t nodeCount = context.getOverlay().getNodeCount();
+    context.startSearch(nodeCount);
 
-    auto edges = aStarEdges(newNodeIdStart, newNodeIdEnd, useWeighting);
+    Queue &openSet = context.getQueue<Queue>();
+    openSet.reset(nodeCount);
 
-    mGraph->removeSplitItems();
+    context.setLabel(startIndex, 0.0, SearchContext::INVALID_INDEX, SearchContext::INVALID_INDEX, false);
+    openSet.push(startIndex, potential(startIndex));
 
-    return edges;
+    while (!openSet.empty())
+    {
+        const uint32_t currentIndex = openSet.pop();
+
+        if (context.isSettled(currentIndex))
+            continue;
+        context.settle(currentIndex);
+
+        // Ziel erreicht?
+        if (currentIndex == goalIndex)
+            break;
+
+        const double currentG = context.getCost(currentIndex);
+
+        // Alle Nachbarn durchsuchen
+        forEachArc(context, currentIndex, [&](const CsrGraph::Arc &arc, double weightFactor)
+        {
+            if (context.isSettled(arc.target))
+                return;
+
+            double tentativeG = currentG + getArcCost(profile, arc, weightFactor);
+            if (tentativeG < context.getCost(arc.target))
+            {
+                context.setLabel(arc.target, tentativeG, currentIndex, arc.edge, arc.reversed);
+                double f = tentativeG + potential(arc.target);
+                openSet.push(arc.target, f);
+            }
+        });
+    }
 }
 
-void Router::aStarRouting(uint64_t &startId, uint64_t &goalId, uint8_t snapToRoads, bool useWeighting)
+void Router::aStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const
 {
-    if(useWeighting && !mWeights)
+    const Coordinates goalCoordinates = getNodeCoordinates(context, goalIndex);
+    const double heuristicScale = 1.0 / (snapToRoads * (NO_EDGE_SNAP_PENALTY - 1) + 1);
+
+    aStarRouting(context, startIndex, goalIndex, profile, [&](uint32_t nodeIndex)
     {
-        std::cerr << "Weighting enabled but no weights provided. Please provide a weight CSV file when initializing the Router.\n";
-        useWeighting = false;
+        return Router::heuristic(getNodeCoordinates(context, nodeIndex), goalCoordinates) * heuristicScale;
+    });
+}
+
+void Router::landmarkRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const Profile &profile) const
+{
+    // The tables only cover the CSR graph; split items in the Graph have no landmark distances.
+    // The bounds come from the costs at preparation time, so unlike the haversine heuristic they are not scaled for snapToRoads.
+    const Landmarks<float> *landmarks = profile.landmarks.get();
+    if(!landmarks || !mGraph->getSplitItemIds().empty() || profile.landmarksRevision != profile.getRevision())
+    {
+        // Bounds from older weights may overestimate the current costs and make the search return wrong paths
+        std::cerr << (landmarks && profile.landmarksRevision != profile.getRevision() ? "Weights changed since the landmarks were prepared, falling back to A*.\n"
+                                                                                      : "No landmarks prepared for this query, falling back to A*.\n");
+        aStarRouting(context, startIndex, goalIndex, snapToRoads, *profile.costs);
+        return;
     }
-    currentEpoch++;
 
-    auto prepareNode = [&](std::shared_ptr<Node>& node)
+    const uint32_t csrNodeCount = mCsrGraph->getNodeCount();
+    const uint32_t landmarkCount = landmarks->getLandmarkCount();
+
+    // Phantom nodes reach the landmarks through the end nodes of their edge
+    std::vector<double> endDistances(landmarkCount);
+    auto getDistances = [&](uint32_t nodeIndex, std::vector<double> &distances)
     {
-        if (node->searchEpoch != currentEpoch)
+        distances.assign(landmarkCount, std::numeric_limits<double>::infinity());
+        if (nodeIndex < csrNodeCount)
         {
-            node->g = std::numeric_limits<double>::infinity();
-            node->f = std::numeric_limits<double>::infinity();
-            node->visited = false;
-            node->parent = 0;
-            node->parentEdge = nullptr;
-            node->parentEdgeReversed = false;
-            node->searchEpoch = currentEpoch;
+            landmarks->getDistances(nodeIndex, distances.data());
+            return;
         }
+
+        forEachArc(context, nodeIndex, [&](const CsrGraph::Arc &arc, double weightFactor)
+        {
+            if (arc.target >= csrNodeCount)
+                return;
+
+            landmarks->getDistances(arc.target, endDistances.data());
+            const double cost = getArcCost(*profile.costs, arc, weightFactor);
+            for (uint32_t landmark = 0; landmark < landmarkCount; landmark++)
+            {
+                distances[landmark] = std::min(distances[landmark], endDistances[landmark] + cost);
+            }
+        });
     };
 
-    std::shared_ptr<Node> start = mGraph->getNodes().at(startId);
-    std::shared_ptr<Node> goal = mGraph->getNodes().at(goalId);
+    std::vector<double> goalDistances;
+    std::vector<double> phantomDistances;
+    getDistances(goalIndex, goalDistances);
 
-    prepareNode(start);
-    prepareNode(goal);
+    aStarRouting(context, startIndex, goalIndex, *profile.costs, [&](uint32_t nodeIndex)
+    {
+        if (nodeIndex < csrNodeCount)
+        {
+            return landmarks->getLowerBound(nodeIndex, goalDistances.data());
+        }
+        getDistances(nodeIndex, phantomDistances);
+        return landmarks->getLowerBound(phantomDistances.data(), goalDistances.data());
+    });
+}
 
-    start->g = 0.0;
-    start->f = Router::heuristic(*start, *goal) / (snapToRoads * (NO_EDGE_SNAP_PENALTY - 1) + 1);
+void Router::bidirectionalAStarRouting(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const
+{
+    switch (mPriorityQueue)
+    {
+        case PriorityQueue::BinaryHeap:
+            bidirectionalAStarSearch<BinaryHeap>(context, startIndex, goalIndex, snapToRoads, profile);
+            break;
+        case PriorityQueue::QuaternaryHeap:
+            bidirectionalAStarSearch<QuaternaryHeap>(context, startIndex, goalIndex, snapToRoads, profile);
+            break;
+        case PriorityQueue::RadixHeap:
+            bidirectionalAStarSearch<RadixHeap>(context, startIndex, goalIndex, snapToRoads, profile);
+            break;
+    }
+}
 
-    using PQItem = std::pair<double, uint64_t>; // (f, nodeId)
-    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> openSet;
-    openSet.emplace(start->f, start->getId());
+template <typename Queue>
+void Router::bidirectionalAStarSearch(SearchContext &context, uint32_t startIndex, uint32_t goalIndex, uint8_t snapToRoads, const CompiledProfile &profile) const
+{
+    SearchContext &backward = context.getBackwardContext();
+    const uint32_t nodeCount = context.getOverlay().getNodeCount();
+    context.startSearch(nodeCount);
+    backward.startSearch(nodeCount);
 
-    while (!openSet.empty())
+    const Coordinates startCoordinates = getNodeCoordinates(context, startIndex);
+    const Coordinates goalCoordinates = getNodeCoordinates(context, goalIndex);
+    const double heuristicScale = 1.0 / (snapToRoads * (NO_EDGE_SNAP_PENALTY - 1) + 1);
+
+    // Average potential: consistent for both directions, and both searches see the same reduced arc costs
+    auto forwardPotential = [&](uint32_t nodeIndex)
     {
-        auto [currentF, currentId] = openSet.top();
-        openSet.pop();
+        const Coordinates coordinates = getNodeCoordinates(context, nodeIndex);
+        return (Router::heuristic(coordinates, goalCoordinates) - Router::heuristic(startCoordinates, coordinates)) * heuristicScale / 2.0;
+    };
 
-        std::shared_ptr<Node> current = mGraph->getNodes().at(currentId);
+    Queue &forwardOpenSet = context.getQueue<Queue>();
+    Queue &backwardOpenSet = backward.getQueue<Queue>();
+    forwardOpenSet.reset(nodeCount);
+    backwardOpenSet.reset(nodeCount);
 
-        if (current->visited)
-            continue;
-        current->visited = true;
+    context.setLabel(startIndex, 0.0, SearchContext::INVALID_INDEX, SearchContext::INVALID_INDEX, false);
+    forwardOpenSet.push(startIndex, forwardPotential(startIndex));
+    backward.setLabel(goalIndex, 0.0, SearchContext::INVALID_INDEX, SearchContext::INVALID_INDEX, false);
+    backwardOpenSet.push(goalIndex, -forwardPotential(goalIndex));
 
-        // Ziel erreicht?
-        if (currentId == goalId)
-            break;
+    double bestCost = startIndex == goalIndex ? 0.0 : std::numeric_limits<double>::infinity();
+    uint32_t meetingIndex = startIndex == goalIndex ? startIndex : SearchContext::INVALID_INDEX;
 
-        // Alle Nachbarn durchsuchen
-        for (const auto &edge : current->edges)
+    // The open sets cannot be peeked, so each direction pops its next unsettled node ahead and holds it until it is expanded.
+    // Its key is recomputed from the cost label, so the stopping test compares exactly the sums of costs and potentials
+    // that bestCost is made of. Returns infinity once the direction is exhausted.
+    auto popNext = [&](Queue &openSet, const SearchContext &labels, double potentialSign, uint32_t &nodeIndex) -> double
+    {
+        while (!openSet.empty())
         {
-            auto fromNode = edge->from();
-            auto toNode = edge->to();
+            nodeIndex = openSet.pop();
+            if (!labels.isSettled(nodeIndex))
+                return labels.getCost(nodeIndex) + potentialSign * forwardPotential(nodeIndex);
+        }
+        return std::numeric_limits<double>::infinity();
+    };
 
-            if (!fromNode || !toNode)
-                continue;
+    auto expand = [&](uint32_t currentIndex, Queue &openSet, SearchContext &labels, const SearchContext &otherLabels, double potentialSign)
+    {
+        labels.settle(currentIndex);
 
-            // Nächster Nachbar bestimmen
-            std::shared_ptr<Node> neighbor = (fromNode->getId() == currentId) ? toNode : fromNode;
-            prepareNode(neighbor);
+        const double currentG = labels.getCost(currentIndex);
 
-            if (neighbor->visited)
-                continue;
+        forEachArc(context, currentIndex, [&](const CsrGraph::Arc &arc, double weightFactor)
+        {
+            if (labels.isSettled(arc.target))
+                return;
 
-            double tentativeG = current->g + edge->getWeight() + edge->getWeight() * (useWeighting ? mWeights->getWeight(edge->getParameters()) : 0.0);
-            if (tentativeG < neighbor->g)
+            double tentativeG = currentG + getArcCost(profile, arc, weightFactor);
+            if (tentativeG < labels.getCost(arc.target))
             {
-                neighbor->parent = currentId;
-                neighbor->parentEdge = edge.get();
-                neighbor->parentEdgeReversed = (toNode->getId() == currentId);
-                neighbor->g = tentativeG;
-                neighbor->f = tentativeG + Router::heuristic(*neighbor, *goal) / (snapToRoads * (NO_EDGE_SNAP_PENALTY - 1) + 1);
-                openSet.emplace(neighbor->f, neighbor->getId());
+                labels.setLabel(arc.target, tentativeG, currentIndex, arc.edge, arc.reversed);
+                openSet.push(arc.target, tentativeG + potentialSign * forwardPotential(arc.target));
+
+                if (otherLabels.isReached(arc.target) && tentativeG + otherLabels.getCost(arc.target) < bestCost)
+                {
+                    bestCost = tentativeG + otherLabels.getCost(arc.target);
+                    meetingIndex = arc.target;
+                }
             }
+        });
+    };
+
+    uint32_t forwardIndex = SearchContext::INVALID_INDEX;
+    uint32_t backwardIndex = SearchContext::INVALID_INDEX;
+    double forwardKey = popNext(forwardOpenSet, context, 1.0, forwardIndex);
+    double backwardKey = popNext(backwardOpenSet, backward, -1.0, backwardIndex);
+
+    // Both searches run on the same reduced costs, so the plain bidirectional Dijkstra criterion applies;
+    // an exhausted direction has key infinity and ends the search as well
+    while (forwardKey + backwardKey < bestCost)
+    {
+        if (forwardKey <= backwardKey)
+        {
+            expand(forwardIndex, forwardOpenSet, context, backward, 1.0);
+            forwardKey = popNext(forwardOpenSet, context, 1.0, forwardIndex);
+        }
+        else
+        {
+            expand(backwardIndex, backwardOpenSet, backward, context, -1.0);
+            backwardKey = popNext(backwardOpenSet, backward, -1.0, backwardIndex);
         }
     }
+
+    if (meetingIndex == SearchContext::INVALID_INDEX)
+        return;
+
+    // Hang the backward half of the path into the forward labels, so the path is reconstructed like a unidirectional one
+    for (uint32_t nodeIndex = meetingIndex; nodeIndex != goalIndex;)
+    {
+        const uint32_t nextIndex = backward.getParent(nodeIndex);
+        context.setLabel(nextIndex, bestCost, nodeIndex, backward.getParentEdge(nodeIndex), !backward.isParentEdgeReversed(nodeIndex));
+        nodeIndex = nextIndex;
+    }
 }
 
-std::vector<std::tuple<uint64_t, Coordinates>> Router::aStar(Coordinates startCoords, Coordinates goalCoords, uint8_t snapToRoads, bool useWeighting)
+DistanceMatrix Router::distanceMatrix(const std::vector<uint64_t> &sourceIds, const std::vector<uint64_t> &targetIds, bool useWeighting, unsigned threadCount) const
 {
-    auto [closestStartPoint, closestStartEdgeId, startSegment] = getEdgeSplit(startCoords);
-    uint64_t newNodeIdStart = mGraph->addSplit(closestStartPoint, closestStartEdgeId, startSegment);
+    return distanceMatrix(sourceIds, targetIds, *getRoutingProfile(useWeighting).costs, threadCount);
+}
 
-    auto [closestEndPoint, closestEndEdgeId, endSegment] = getEdgeSplit(goalCoords);
-    uint64_t newNodeIdEnd = mGraph->addSplit(closestEndPoint, closestEndEdgeId, endSegment);
+DistanceMatrix Router::distanceMatrix(const std::vector<Coordinates> &sourceCoords, const std::vector<Coordinates> &targetCoords, bool useWeighting, unsigned threadCount) const
+{
+    return distanceMatrix(sourceCoords, targetCoords, *getRoutingProfile(useWeighting).costs, threadCount);
+}
 
-    std::vector<std::tuple<uint64_t, Coordinates>> path = aStar(newNodeIdStart, newNodeIdEnd, snapToRoads, useWeighting);
+DistanceMatrix Router::distanceMatrix(const std::vector<uint64_t> &sourceIds, const std::vector<uint64_t> &targetIds, const CompiledProfile &profile, unsigned threadCount) const
+{
+    SearchContext context;
+    prepareOverlay(context);
 
-    mGraph->removeSplitItems();
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> targets;
+    for (uint64_t sourceId : sourceIds) sources.push_back(mGraph->getNodeIndex(sourceId));
+    for (uint64_t targetId : targetIds) targets.push_back(mGraph->getNodeIndex(targetId));
 
-    return path;
+    return computeDistanceMatrix(context.getOverlay(), sources, targets, getEntry(profile), threadCount);
+}
+
+DistanceMatrix Router::distanceMatrix(const std::vector<Coordinates> &sourceCoords, const std::vector<Coordinates> &targetCoords, const CompiledProfile &profile, unsigned threadCount) const
+{
+    // All phantom nodes share one overlay, so phantom nodes on the same edge are connected directly
+    SearchContext context;
+    prepareOverlay(context);
+
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> targets;
+    for (const Coordinates &coords : sourceCoords) sources.push_back(addPhantomNode(context, coords));
+    for (const Coordinates &coords : targetCoords) targets.push_back(addPhantomNode(context, coords));
+
+    return computeDistanceMatrix(context.getOverlay(), sources, targets, getEntry(profile), threadCount);
+}
+
+DistanceMatrix Router::computeDistanceMatrix(const CsrGraph::Overlay &overlay, const std::vector<uint32_t> &sources, const std::vector<uint32_t> &targets, const Profile &matrixProfile, unsigned threadCount) const
+{
+    // Lengths come from the distance profile, costs from the selected one
+    const CompiledProfile &lengthProfile = *mDistanceProfile->costs;
+    const CompiledProfile &profile = *matrixProfile.costs;
+
+    const uint32_t nodeCount = overlay.getNodeCount();
+
+    DistanceMatrix matrix;
+    matrix.sourceCount = static_cast<uint32_t>(sources.size());
+    matrix.targetCount = static_cast<uint32_t>(targets.size());
+    matrix.costs.assign(sources.size() * targets.size(), std::numeric_limits<double>::infinity());
+    matrix.lengths.assign(sources.size() * targets.size(), std::numeric_limits<double>::infinity());
+
+    // Duplicate targets are settled once
+    std::vector<uint8_t> isTarget(nodeCount, 0);
+    uint32_t distinctTargetCount = 0;
+    for (uint32_t target : targets)
+    {
+        if (!isTarget[target]) distinctTargetCount++;
+        isTarget[target] = 1;
+    }
+
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned>(threadCount, std::max<size_t>(1, sources.size()));
+
+    // Workers take the next source from a shared counter; each keeps its own context and length labels
+    std::atomic<size_t> nextSource{0};
+    auto worker = [&]()
+    {
+        SearchContext context;
+        context.getOverlay() = overlay;
+        std::vector<double> lengths(nodeCount);
+
+        for (size_t sourceIndex = nextSource++; sourceIndex < sources.size(); sourceIndex = nextSource++)
+        {
+            const uint32_t source = sources[sourceIndex];
+            context.startSearch(nodeCount);
+
+            BinaryHeap &openSet = context.getQueue<BinaryHeap>();
+            openSet.reset(nodeCount);
+
+            context.setLabel(source, 0.0, SearchContext::INVALID_INDEX, SearchContext::INVALID_INDEX, false);
+            lengths[source] = 0.0;
+            openSet.push(source, 0.0);
+
+            uint32_t remainingTargets = distinctTargetCount;
+            while (!openSet.empty() && remainingTargets > 0)
+            {
+                const uint32_t currentIndex = openSet.pop();
+
+                if (context.isSettled(currentIndex))
+                    continue;
+                context.settle(currentIndex);
+
+                if (isTarget[currentIndex])
+                    remainingTargets--;
+
+                const double currentCost = context.getCost(currentIndex);
+                forEachArc(context, currentIndex, [&](const CsrGraph::Arc &arc, double weightFactor)
+                {
+                    if (context.isSettled(arc.target))
+                        return;
+
+                    const double cost = currentCost + getArcCost(profile, arc, weightFactor);
+                    if (cost < context.getCost(arc.target))
+                    {
+                        context.setLabel(arc.target, cost, currentIndex, arc.edge, arc.reversed);
+                        lengths[arc.target] = lengths[currentIndex] + getArcCost(lengthProfile, arc, weightFactor);
+                        openSet.push(arc.target, cost);
+                    }
+                });
+            }
+
+            for (size_t targetIndex = 0; targetIndex < targets.size(); targetIndex++)
+            {
+                const uint32_t target = targets[targetIndex];
+                if (!context.isSettled(target))
+                    continue;
+                matrix.costs[sourceIndex * targets.size() + targetIndex] = context.getCost(target);
+                matrix.lengths[sourceIndex * targets.size() + targetIndex] = lengths[target];
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    return matrix;
 }
 
-double Router::heuristic(const Node &a, const Node &b)
+double Router::heuristic(const Coordinates &a, const Coordinates &b)
 {
-    return HelperFunctions::haversine(a.getCoordinates(), b.getCoordinates());
+    return HelperFunctions::haversine(a, b);
 }
 
 Coordinates Router::getClosestPointOnEdge(Coordinates coords, uint64_t edgeId, uint8_t segmentIndex) const
@@ -236,7 +918,7 @@ std::tuple<Coordinates, uint64_t, uint8_t> Router::getEdgeSplit(Coordinates coor
 
 std::tuple<uint64_t, uint8_t> Router::getClosestSegment(Coordinates coords) const
 {
-    auto closestEdges = mQuadtree->getClosestEdges(coords);
+    auto closestEdges = mRTree->getClosestEdges(coords);
 
     for(uint64_t id : mGraph->getSplitItemIds())
     {
@@ -244,7 +926,7 @@ std::tuple<uint64_t, uint8_t> Router::getClosestSegment(Coordinates coords) cons
         if((id & 0x00FFFFFFFFFFFFFF) == (closestEdges[0].edge->getId() & 0x00FFFFFFFFFFFFFF))
         {
             double minDistance = std::numeric_limits<double>::infinity();
-            auto &path = mGraph->getEdge(id)->getPath();
+            const auto path = mGraph->getEdge(id)->getPath();
             uint8_t segmentIndex = 0;
             for (size_t i = 0; i < path.size() - 1; ++i)
             {
@@ -0,0 +1,35 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "graphsnapshot.hpp"
+#include "router.hpp"
+
+// Parses an OSM file once and writes the graph snapshot that router_app loads instead
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <osm_file.osm> [snapshot_file]\n";
+        return 1;
+    }
+
+    const std::string osmFile = argv[1];
+    const std::string snapshotFile = argc >= 3 ? argv[2] : osmFile + ".snapshot";
+
+    try
+    {
+        Router router(osmFile);
+        GraphSnapshot::write(snapshotFile, router.getGraph(), router.getRTree(), router.getBoundary());
+        std::cout << "Snapshot mit " << router.getGraph().getNodeCount() << " Knoten und " << router.getGraph().getEdgeCount()
+                  << " Kanten geschrieben: " << snapshotFile << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler beim Erstellen des Snapshots: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -10,10 +10,11 @@ std::vector<Edge *> Routes::getEdgeSet(const std::vector<Coordinates> &coordinat
     std::vector<Edge *> edges;
     std::vector<Edge *> modifiedEdges;
 
-    for(auto coords : coordinates)
+    const ClosestEdgesBatch closestEdges = mRouter.getRTree().getClosestEdgesBatch(coordinates);
+    for(uint32_t index = 0; index < coordinates.size(); index++)
     {
-        auto closestEdge = mRouter.getQuadtree().getClosestEdges(coords)[0];
-        auto edge = closestEdge.edge;
+        const Coordinates &coords = coordinates[index];
+        auto edge = closestEdges.getClosestEdges(index)[0].edge;
 
         double distanceFrom = HelperFunctions::haversine(coords, edge->from()->getCoordinates());
         double distanceTo = HelperFunctions::haversine(coords, edge->to()->getCoordinates());
@@ -30,6 +31,7 @@ std::vector<Edge *> Routes::getEdgeSet(const std::vector<Coordinates> &coordinat
                 for(const auto edge : modifiedEdges)
                 {
                     edge->setWeight(edge->calculateWayLength());
+                    mRouter.updateEdgeCost(*edge);
                 }
                 modifiedEdges.clear();
             }
@@ -37,13 +39,14 @@ std::vector<Edge *> Routes::getEdgeSet(const std::vector<Coordinates> &coordinat
         else
         {
             edge->setWeight(edge->getWeight() / NO_EDGE_SNAP_PENALTY);
+            mRouter.updateEdgeCost(*edge);
             modifiedEdges.emplace_back(edge);
         }
     }
 
     // emplace first and last edge because they are not included in the routing process
-    edges.push_back(mRouter.getQuadtree().getClosestEdges(coordinates[0])[0].edge);
-    edges.push_back(mRouter.getQuadtree().getClosestEdges(coordinates[coordinates.size() - 1])[0].edge);
+    edges.push_back(closestEdges.getClosestEdges(0)[0].edge);
+    edges.push_back(closestEdges.getClosestEdges(coordinates.size() - 1)[0].edge);
 
     prepareEdgeSet(edges);
 
@@ -149,7 +152,7 @@ std::unordered_map<std::string, std::unordered_map<std::string, double>> Routes:
 
         for(const auto &[key, value] : parameters)
         {
-            parameterLengthMap[key][value] += edgeLength;
+            parameterLengthMap[std::string(key)][std::string(value)] += edgeLength;
         }
     }
 
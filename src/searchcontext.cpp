@@ -0,0 +1,31 @@
+#include "searchcontext.hpp"
+
+#include <algorithm>
+
+void SearchContext::startSearch(uint32_t nodeCount)
+{
+    if(mEpochs.size() < nodeCount)
+    {
+        mCosts.resize(nodeCount);
+        mParents.resize(nodeCount);
+        mParentEdges.resize(nodeCount);
+        mFlags.resize(nodeCount);
+        mEpochs.resize(nodeCount, 0);
+    }
+
+    // Epoch 0 marks never reached nodes; on overflow all labels have to be cleared once
+    if(++mEpoch == 0)
+    {
+        std::fill(mEpochs.begin(), mEpochs.end(), 0);
+        mEpoch = 1;
+    }
+}
+
+SearchContext &SearchContext::getBackwardContext()
+{
+    if(!mBackwardContext)
+    {
+        mBackwardContext = std::make_unique<SearchContext>();
+    }
+    return *mBackwardContext;
+}
@@ -13,6 +13,7 @@
   #include <sys/socket.h>
 #endif
 
+#include <cctype>
 #include <cerrno>
 #include <cstring>
 #include <cstdlib>
@@ -90,14 +91,23 @@ bool RouterServer::receiveLine(int fd, std::string &line) const
 void RouterServer::handleClient(int clientFd)
 {
     auto &nodelist = mRouter.getGraph().getNodes();
+    const std::string defaultProfile = mRouter.hasProfile(Router::DEFAULT_PROFILE) ? Router::DEFAULT_PROFILE : Router::DISTANCE_PROFILE;
+
+    std::string profiles;
+    for (const std::string &name : mRouter.getProfileNames())
+    {
+        profiles += (profiles.empty() ? "" : ", ") + name;
+    }
+
     sendAll(clientFd, "Verbunden mit Router-Server. "
                       "Geben Sie \"<startId> <zielId>\", \"-c <startLat>,<startLon> <zielLat>,<zielLon>\", "
-                      "leer fuer Zufall oder \"exit\" ein.\n");
+                      "leer fuer Zufall oder \"exit\" ein. Mit \"-p <profil>\" vor der Anfrage wird das Profil gewaehlt "
+                      "(verfuegbar: " + profiles + "; Standard: " + defaultProfile + ").\n");
 
     std::string line;
     while (true)
     {
-        if (!sendAll(clientFd, "Bitte '-i <startId> <zielId>' oder '-c <lat>,<lon> <lat>,<lon>' eingeben (Enter fuer Zufall): "))
+        if (!sendAll(clientFd, "Bitte '[-p <profil>] -i <startId> <zielId>' oder '[-p <profil>] -c <lat>,<lon> <lat>,<lon>' eingeben (Enter fuer Zufall): "))
         {
             break;
         }
@@ -115,6 +125,7 @@ void RouterServer::handleClient(int clientFd)
         double goalLat = 0.0;
         double goalLon = 0.0;
         bool useCoordinates = false;
+        std::string profileName = defaultProfile;
 
         if (line.empty())
         {
@@ -137,10 +148,20 @@ void RouterServer::handleClient(int clientFd)
                 break;
             }
 
-            if (!line.empty() && line[0] == '-')
+            // Options precede the start and goal; the profile applies to this request only
+            bool validOptions = true;
+            while (validOptions && (iss >> std::ws, iss.peek() == '-'))
             {
+                const std::streampos position = iss.tellg();
                 std::string flag;
                 iss >> flag;
+                if (flag.size() > 1 && (std::isdigit(static_cast<unsigned char>(flag[1])) || flag[1] == '.'))
+                {
+                    // Negative coordinate, not an option
+                    iss.seekg(position);
+                    break;
+                }
+
                 if (flag == "-c" || flag == "--coords" || flag == "--coordinates")
                 {
                     useCoordinates = true;
@@ -149,16 +170,23 @@ void RouterServer::handleClient(int clientFd)
                 {
                     useCoordinates = false;
                 }
+                else if (flag == "-p" || flag == "--profile")
+                {
+                    if (!(iss >> profileName) || !mRouter.hasProfile(profileName))
+                    {
+                        sendAll(clientFd, "Unbekanntes Profil. Verfuegbar: " + profiles + "\n");
+                        validOptions = false;
+                    }
+                }
                 else
                 {
-                    sendAll(clientFd, "Unbekannte Option. Nutzen Sie '-i' fuer IDs oder '-c' fuer Koordinaten.\n");
-                    continue;
+                    sendAll(clientFd, "Unbekannte Option. Nutzen Sie '-i' fuer IDs, '-c' fuer Koordinaten oder '-p' fuer das Profil.\n");
+                    validOptions = false;
                 }
             }
-            else
+            if (!validOptions)
             {
-                iss.clear();
-                iss.str(line);
+                continue;
             }
 
             if (useCoordinates)
@@ -205,16 +233,17 @@ void RouterServer::handleClient(int clientFd)
             }
         }
 
+        const CompiledProfile &profile = mRouter.getProfile(profileName);
         std::vector<std::tuple<uint64_t, Coordinates>> path;
         if (useCoordinates)
         {
             Coordinates startCoords(startLat, startLon);
             Coordinates goalCoords(goalLat, goalLon);
-            path = mRouter.aStar(startCoords, goalCoords, 0, true);
+            path = mRouter.aStar(mSearchContext, startCoords, goalCoords, profile);
         }
         else
         {
-            path = mRouter.aStar(startId, goalId, 0, true);
+            path = mRouter.aStar(mSearchContext, startId, goalId, profile);
         }
 
         if (path.empty())
@@ -239,7 +268,7 @@ void RouterServer::handleClient(int clientFd)
         {
             response << startId << " nach " << goalId;
         }
-        response << " mit " << path.size() << " Punkten exportiert nach " << filepath << "\n";
+        response << " (Profil " << profileName << ") mit " << path.size() << " Punkten exportiert nach " << filepath << "\n";
         sendAll(clientFd, response.str());
     }
 }
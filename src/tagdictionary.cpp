@@ -0,0 +1,95 @@
+#include "tagdictionary.hpp"
+
+#include <mutex>
+
+TagDictionary::TagDictionary()
+{
+    // ID 0 is the empty set, so default constructed Parameters need no lookup
+    mTagSets.emplace_back();
+    mTagSetIds.emplace(std::span<const Tag>(mTagSets.back()), EMPTY_TAG_SET);
+}
+
+TagDictionary &TagDictionary::getInstance()
+{
+    static TagDictionary dictionary;
+    return dictionary;
+}
+
+uint32_t TagDictionary::intern(std::string_view string)
+{
+    {
+        std::shared_lock lock(mMutex);
+        auto it = mStringIds.find(string);
+        if(it != mStringIds.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mMutex);
+    auto it = mStringIds.find(string);
+    if(it != mStringIds.end())
+    {
+        return it->second;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(mStrings.size());
+    mStrings.emplace_back(string);
+    mStringIds.emplace(std::string_view(mStrings.back()), id);
+    return id;
+}
+
+uint32_t TagDictionary::find(std::string_view string) const
+{
+    std::shared_lock lock(mMutex);
+    auto it = mStringIds.find(string);
+    return it != mStringIds.end() ? it->second : INVALID_ID;
+}
+
+std::string_view TagDictionary::getString(uint32_t id) const
+{
+    std::shared_lock lock(mMutex);
+    return mStrings[id];
+}
+
+uint32_t TagDictionary::internTags(std::span<const Tag> tags)
+{
+    {
+        std::shared_lock lock(mMutex);
+        auto it = mTagSetIds.find(tags);
+        if(it != mTagSetIds.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mMutex);
+    auto it = mTagSetIds.find(tags);
+    if(it != mTagSetIds.end())
+    {
+        return it->second;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(mTagSets.size());
+    mTagSets.emplace_back(tags.begin(), tags.end());
+    mTagSetIds.emplace(std::span<const Tag>(mTagSets.back()), id);
+    return id;
+}
+
+std::span<const Tag> TagDictionary::getTags(uint32_t tagSetId) const
+{
+    std::shared_lock lock(mMutex);
+    return mTagSets[tagSetId];
+}
+
+size_t TagDictionary::getStringCount() const
+{
+    std::shared_lock lock(mMutex);
+    return mStrings.size();
+}
+
+size_t TagDictionary::getTagSetCount() const
+{
+    std::shared_lock lock(mMutex);
+    return mTagSets.size();
+}
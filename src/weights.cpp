@@ -21,50 +21,43 @@ Weights::Weights(const std::string &weightsCSVFile)
 
         if (std::getline(ss, key, ',') && std::getline(ss, value, ',') && ss >> weight)
         {
-            mWeights[key][value] = weight;
+            setWeight(key, value, weight);
         }
     }
 }
 
 double Weights::getWeight(const Parameters &parameters) const
 {
-    if(parameters.getParameters().empty())
+    return getWeight(parameters.getTags());
+}
+
+double Weights::getWeight(std::span<const Tag> tags) const
+{
+    double weight = 0.0;
+    for(const Tag &tag : tags)
     {
-        return fallbackWeight;
+        auto it = mTagWeights.find(getTagKey(tag));
+        weight += it != mTagWeights.end() ? it->second : fallbackWeight;
     }
+    return weight;
+}
 
-    double weight = 0.0;
-    size_t weightCount = 0;
+void Weights::setWeight(const std::string &key, const std::string &value, double weight)
+{
+    mWeights[key][value] = weight;
 
-    for(const auto &[key, value] : parameters.getParameters())
+    TagDictionary &dictionary = TagDictionary::getInstance();
+    const Tag tag{dictionary.intern(key), dictionary.intern(value)};
+    auto [it, inserted] = mTagWeights.try_emplace(getTagKey(tag), weight);
+    if(inserted || it->second != weight)
     {
-        weightCount++;
-        auto keyWeights = getKeyWeights(key);
-        if(keyWeights.empty())
-        {
-            weight += fallbackWeight; // Default weight for unknown parameter keys
-            continue;
-        }
-
-        auto it = keyWeights.find(value);
-        if(it != keyWeights.end())
+        it->second = weight;
+        mRevision++;
+        for(const auto &listener : mChangeListeners)
         {
-            weight += it->second;
-        }
-        else
-        {
-            if(key.find("cross:") != std::string::npos)
-            {
-                weight += 0;
-            }
-            else
-            {
-                weight += fallbackWeight; // Fallback default weight if no "default" value is defined
-            }
+            listener(tag);
         }
     }
-
-    return weight;
 }
 
 void Weights::saveWeights(const std::string &filename)
@@ -82,38 +75,18 @@ void Weights::saveWeights(const std::string &filename)
     file.close();
 }
 
-ankerl::unordered_dense::map<std::string, double> Weights::getKeyWeights(const std::string &key) const
-{
-    auto it = mWeights.find(key);
-    if(it != mWeights.end())
-    {
-        return it->second;
-    }
-    return {};
-}
-
 double Weights::getWeight(const std::string &key, const std::string &value) const
 {
-    auto keyWeights = getKeyWeights(key);
-    if(keyWeights.empty())
+    auto keyIt = mWeights.find(key);
+    if(keyIt == mWeights.end())
     {
         return fallbackWeight; // Default weight for unknown parameter keys
     }
 
-    auto it = keyWeights.find(value);
-    if(it != keyWeights.end())
+    auto it = keyIt->second.find(value);
+    if(it != keyIt->second.end())
     {
         return it->second;
     }
-    else
-    {
-        if(key.find("cross:") != std::string::npos)
-        {
-            return 0;
-        }
-        else
-        {
-            return fallbackWeight; // Fallback default weight if no "default" value is defined
-        }
-    }
-}
\ No newline at end of file
+    return fallbackWeight; // Fallback default weight if no "default" value is defined
+}
@@ -3,6 +3,9 @@
 #include <memory>
 #include <string>
 #include <cassert>
+#include <algorithm>
+#include <span>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 
@@ -21,6 +24,10 @@ int main()
         Router router(osmPath);
 
         {
+            const size_t geometrySize = router.getGraph().getGeometrySize();
+            const std::span<const Coordinates> firstPath = router.getGraph().getEdgeByIndex(0)->getPath();
+            const std::vector<Coordinates> firstPathBefore(firstPath.begin(), firstPath.end());
+
             Coordinates startCoordinates = {49.053453, 8.384183};
             Coordinates endCoordinates = {49.055255, 8.381203};
 
@@ -33,7 +40,16 @@ int main()
             std::vector<std::tuple<uint64_t, Coordinates>> path = router.aStar(newNodeIdStart, newNodeIdEnd);
 
             router.getGraph().removeSplitItems();
-            
+
+            // Only the geometry of the split edges is dropped from the pool
+            assert(router.getGraph().getGeometrySize() == geometrySize);
+            const std::span<const Coordinates> firstPathAfter = router.getGraph().getEdgeByIndex(0)->getPath();
+            assert(std::equal(firstPathAfter.begin(), firstPathAfter.end(), firstPathBefore.begin(), firstPathBefore.end(),
+                              [](const Coordinates &a, const Coordinates &b)
+                              {
+                                  return a.getFixedLatitude() == b.getFixedLatitude() && a.getFixedLongitude() == b.getFixedLongitude();
+                              }));
+
             HelperFunctions::exportPathToGeoJSON(path, "add_split_test_path.geojson");
             assert(!path.empty());
         }
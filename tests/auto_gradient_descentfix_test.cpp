@@ -111,6 +111,9 @@ int main()
         {
             std::cout << std::format("=== Starte Epoche {}/{} ===\n", epoch, EPOCHS);
 
+            // Hierarchie an die Gewichte der letzten Epoche anpassen
+            router.customizeContractionHierarchy();
+
             double jaccardSum = 0;
             uint8_t jaccardCount = 0;
 
@@ -128,7 +131,7 @@ int main()
 
                 for(uint32_t i = 0; i < track.ids.size(); i += DISTANCE)
                 {
-                    auto result = router.aStarEdges(track.ids[i], track.ids[std::min<uint32_t>(i + DISTANCE, track.ids.size() - 1)], true);
+                    auto result = router.aStarEdges(track.ids[i], track.ids[std::min<uint32_t>(i + DISTANCE, track.ids.size() - 1)], true, RoutingMode::ContractionHierarchy);
                     edgeSet.insert(edgeSet.end(), result.begin(), result.end());
                 }
 
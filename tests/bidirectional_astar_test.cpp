@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+
+        for(int i = 0; i < 200; i++)
+        {
+            uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            bool useWeighting = i % 2;
+
+            router.setPriorityQueue(PriorityQueue::BinaryHeap);
+            auto edges = router.aStarEdges(startId, goalId, useWeighting);
+            double cost = useWeighting ? routes.getCost(edges, router.getWeights()) : routes.getLength(edges);
+
+            // Every open set gives the same cost; the radix heap orders by millimeters
+            for(PriorityQueue queue : {PriorityQueue::BinaryHeap, PriorityQueue::QuaternaryHeap, PriorityQueue::RadixHeap})
+            {
+                router.setPriorityQueue(queue);
+                auto bidirectionalEdges = router.aStarEdges(startId, goalId, useWeighting, RoutingMode::BidirectionalAStar);
+                double bidirectionalCost = useWeighting ? routes.getCost(bidirectionalEdges, router.getWeights()) : routes.getLength(bidirectionalEdges);
+
+                assert(std::abs(cost - bidirectionalCost) <= (queue == PriorityQueue::RadixHeap ? 1e-2 : 1e-6 * cost + 1e-6));
+            }
+            router.setPriorityQueue(PriorityQueue::BinaryHeap);
+
+            auto path = router.aStar(startId, goalId, 0, useWeighting, RoutingMode::BidirectionalAStar);
+            assert(path.empty() == edges.empty() || startId == goalId);
+            if(!path.empty())
+            {
+                assert(std::get<0>(path.front()) == startId);
+                assert(std::get<0>(path.back()) == goalId);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -90,6 +90,9 @@ int main()
         {
             std::cout << std::format("=== Starte Epoche {}/{} ===\n", epoch, EPOCHS);
 
+            // Hierarchie an die Gewichte der letzten Epoche anpassen
+            router.customizeContractionHierarchy();
+
             double jaccardSum = 0;
             uint8_t jaccardCount = 0;
 
@@ -103,7 +106,7 @@ int main()
             // 1. A* Routing mit AKTUELLEN Gewichten für alle Tracks
             for(const auto &track : trainingData)
             {
-                std::vector<Edge *> edgeSet = router.aStarEdges(track.startPoint, track.endPoint, true);
+                std::vector<Edge *> edgeSet = router.aStarEdges(track.startPoint, track.endPoint, true, RoutingMode::ContractionHierarchy);
                 routes.prepareEdgeSet(edgeSet);
 
                 double jaccard = routes.getJaccardCoefficient(edgeSet, track.matchSet);
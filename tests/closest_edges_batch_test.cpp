@@ -0,0 +1,78 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+#include "router.hpp"
+#include "packedrtree.hpp"
+
+Coordinates randomCoordinateGenerator(const Box &box)
+{
+    double lat = box.getMinLatitudeLongitude().getLatitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLatitude() - box.getMinLatitudeLongitude().getLatitude());
+    double lon = box.getMinLatitudeLongitude().getLongitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLongitude() - box.getMinLatitudeLongitude().getLongitude());
+    return Coordinates(lat, lon);
+}
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        const PackedRTree &rtree = router.getRTree();
+
+        // Random points and a dense track through the map, so that the batch mixes distant and neighboring points
+        std::vector<Coordinates> points;
+        Coordinates trackPoint = rtree.getBoundary().getCenter();
+        for(int i = 0; i < 5000; i++)
+        {
+            points.push_back(randomCoordinateGenerator(rtree.getBoundary()));
+            trackPoint = Coordinates(trackPoint.getLatitude() + (static_cast<double>(rand()) / RAND_MAX - 0.5) * 2e-4,
+                                     trackPoint.getLongitude() + (static_cast<double>(rand()) / RAND_MAX - 0.5) * 3e-4);
+            points.push_back(trackPoint);
+        }
+
+        for(uint8_t resultCount : {1, 3})
+        {
+            for(bool multipleSegments : {true, false})
+            {
+                for(unsigned threadCount : {1u, 4u})
+                {
+                    const ClosestEdgesBatch batch = rtree.getClosestEdgesBatch(points, resultCount, multipleSegments, threadCount);
+                    assert(batch.pointCount == points.size() && batch.resultCount == resultCount);
+                    assert(batch.results.size() == points.size() * resultCount);
+
+                    // Results are stored in the order of the points and agree with single queries
+                    for(uint32_t point = 0; point < points.size(); point++)
+                    {
+                        const auto expected = rtree.getClosestEdges(points[point], resultCount, multipleSegments);
+                        const auto closestEdges = batch.getClosestEdges(point);
+                        for(uint8_t result = 0; result < resultCount; result++)
+                        {
+                            assert(closestEdges[result].distance == expected[result].distance);
+                            assert(closestEdges[result].edge != nullptr);
+                        }
+                        for(uint8_t a = 0; a < resultCount; a++)
+                        {
+                            for(uint8_t b = a + 1; b < resultCount; b++)
+                            {
+                                assert(closestEdges[a].edge != closestEdges[b].edge || (multipleSegments && closestEdges[a].subwayId != closestEdges[b].subwayId));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        assert(rtree.getClosestEdgesBatch({}, 3).results.empty());
+        std::cout << "Batch of " << points.size() << " points matches single queries\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "compiledprofile.hpp"
+#include "router.hpp"
+#include "routes.hpp"
+#include "weights.hpp"
+
+int main()
+{
+    try
+    {
+        const std::string osmFile = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmFile, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+        Weights &weights = router.getWeights();
+
+        auto expectedCost = [&](const Edge *edge)
+        {
+            return edge->getWeight() + edge->getWeight() * weights.getWeight(edge->getParameters());
+        };
+        auto matches = [](double cost, float compiled) { return std::abs(cost - compiled) <= 1e-6 * std::abs(cost) + 1e-6; };
+
+        // Both profiles cover every edge and agree with the Weights formula
+        const CompiledProfile &profile = router.getProfile(Router::DISTANCE_PROFILE);
+        const CompiledProfile &weightedProfile = router.getProfile(Router::DEFAULT_PROFILE);
+        assert(!profile.isWeighted() && weightedProfile.isWeighted());
+        assert(profile.getCosts().size() == graph.getEdgeCount() && weightedProfile.getCosts().size() == graph.getEdgeCount());
+        for(uint32_t edgeIndex = 0; edgeIndex < graph.getEdgeCount(); edgeIndex++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+            assert(matches(edge->getWeight(), profile.getCost(edgeIndex)));
+            assert(matches(expectedCost(edge), weightedProfile.getCost(edgeIndex)));
+        }
+
+        // A changed (key, value) weight recompiles exactly the edges carrying that tag
+        const Edge *changedEdge = graph.getEdgeByIndex(0);
+        const auto [key, value] = *changedEdge->getParameters().getParameters().begin();
+        const std::string changedKey(key);
+        const std::string changedValue(value);
+        const std::vector<float> before(weightedProfile.getCosts().begin(), weightedProfile.getCosts().end());
+
+        // Prepared with the weights before the change
+        router.customizeContractionHierarchy(weightedProfile);
+        router.prepareLandmarks(weightedProfile, 4);
+
+        const uint64_t revision = weights.getRevision();
+        weights.setWeight(changedKey, changedValue, weights.getWeight(changedKey, changedValue) + 1.5);
+        assert(weights.getRevision() == revision + 1);
+        weights.setWeight(changedKey, changedValue, weights.getWeight(changedKey, changedValue));
+        assert(weights.getRevision() == revision + 1);
+
+        // The costs follow setWeight without a query in between
+        size_t changedEdges = 0;
+        for(uint32_t edgeIndex = 0; edgeIndex < graph.getEdgeCount(); edgeIndex++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+            assert(matches(expectedCost(edge), weightedProfile.getCost(edgeIndex)));
+
+            const bool hasTag = edge->getParameters().getParameter(changedKey) == changedValue;
+            assert(hasTag == (before[edgeIndex] != weightedProfile.getCost(edgeIndex)) || edge->getWeight() == 0);
+            changedEdges += hasTag;
+        }
+        std::cout << "Weight change of " << changedKey << "=" << changedValue << " recompiled " << changedEdges << " of " << graph.getEdgeCount() << " edges\n";
+
+        // The route cost read from the profile is the one the Weights describe
+        const uint64_t startId = graph.getNodeByIndex(0)->getId();
+        const uint64_t goalId = graph.getNodeByIndex(graph.getNodeCount() - 1)->getId();
+        auto edges = router.aStarEdges(startId, goalId, true);
+        double profileCost = 0;
+        for(const Edge *pathEdge : edges)
+        {
+            profileCost += weightedProfile.getCost(pathEdge->getIndex());
+        }
+        const double cost = routes.getCost(edges, weights);
+        assert(std::abs(profileCost - cost) <= 1e-6 * cost + 1e-6);
+
+        // The hierarchy and the landmarks predate the change, so those modes fall back to A* instead of using stale costs
+        for(RoutingMode mode : {RoutingMode::ContractionHierarchy, RoutingMode::ALT})
+        {
+            const double modeCost = routes.getCost(router.aStarEdges(startId, goalId, true, mode), weights);
+            assert(std::abs(modeCost - cost) <= 1e-6 * cost + 1e-6);
+        }
+
+        // Edge lengths changed outside the router are picked up through updateEdgeCost
+        Edge *edge = graph.getEdgeByIndex(1);
+        const double length = edge->getWeight();
+        edge->setWeight(length * 2);
+        router.updateEdgeCost(*edge);
+        assert(matches(length * 2, profile.getCost(1)));
+        assert(matches(expectedCost(edge), weightedProfile.getCost(1)));
+        edge->setWeight(length);
+        router.updateEdgeCost(*edge);
+        assert(matches(length, profile.getCost(1)));
+
+        // A profile compiled from scratch agrees with the incrementally updated one
+        const CompiledProfile fresh(graph, &weights);
+        for(uint32_t edgeIndex = 0; edgeIndex < graph.getEdgeCount(); edgeIndex++)
+        {
+            assert(fresh.getCost(edgeIndex) == weightedProfile.getCost(edgeIndex));
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+
+        router.prepareContractionHierarchy(false);
+        router.prepareContractionHierarchy(true);
+        const size_t arcCount = router.getContractionHierarchy(false)->getArcCount();
+        assert(router.getContractionHierarchy(true)->isWeighted());
+
+        // The second call loads the saved hierarchy
+        router.prepareContractionHierarchy(false);
+        assert(router.getContractionHierarchy(false)->getArcCount() == arcCount);
+
+        // A truncated or inconsistent file is rebuilt instead of trusted
+        const std::string hierarchyPath = osmPath + ".ch";
+        const uintmax_t hierarchySize = std::filesystem::file_size(hierarchyPath);
+        std::filesystem::resize_file(hierarchyPath, hierarchySize - 1);
+        router.prepareContractionHierarchy(false);
+        assert(router.getContractionHierarchy(false)->getArcCount() == arcCount);
+        assert(std::filesystem::file_size(hierarchyPath) == hierarchySize);
+        // The last arc is a shortcut or an original edge; either way a target out of range makes the file invalid
+        const auto lastTarget = static_cast<std::streamoff>(hierarchySize - sizeof(ContractionHierarchy::Arc) + offsetof(ContractionHierarchy::Arc, target));
+        const uint32_t invalidNode = graph.getNodeCount();
+        {
+            std::fstream file(hierarchyPath, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(lastTarget);
+            file.write(reinterpret_cast<const char *>(&invalidNode), sizeof(invalidNode));
+        }
+        router.prepareContractionHierarchy(false);
+        assert(router.getContractionHierarchy(false)->getArcCount() == arcCount);
+        {
+            // Rebuilding saved a consistent file again
+            std::ifstream file(hierarchyPath, std::ios::binary);
+            uint32_t target = invalidNode;
+            file.seekg(lastTarget);
+            file.read(reinterpret_cast<char *>(&target), sizeof(target));
+            assert(target < invalidNode);
+        }
+
+        for(int i = 0; i < 200; i++)
+        {
+            uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            bool useWeighting = i % 2;
+
+            auto edges = router.aStarEdges(startId, goalId, useWeighting);
+            auto hierarchyEdges = router.aStarEdges(startId, goalId, useWeighting, RoutingMode::ContractionHierarchy);
+
+            double cost = useWeighting ? routes.getCost(edges, router.getWeights()) : routes.getLength(edges);
+            double hierarchyCost = useWeighting ? routes.getCost(hierarchyEdges, router.getWeights()) : routes.getLength(hierarchyEdges);
+
+            assert(std::abs(cost - hierarchyCost) <= 1e-3 * cost + 1e-6);
+
+            auto path = router.aStar(startId, goalId, 0, useWeighting, RoutingMode::ContractionHierarchy);
+            assert(path.empty() == edges.empty() || startId == goalId);
+            if(!path.empty())
+            {
+                assert(std::get<0>(path.front()) == startId);
+                assert(std::get<0>(path.back()) == goalId);
+            }
+        }
+
+        std::cout << "Contraction hierarchy has " << arcCount << " arcs, " << router.getContractionHierarchy(false)->getShortcutCount() << " of them shortcuts.\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
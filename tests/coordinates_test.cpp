@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+
+#include "router.hpp"
+#include "coordinates.hpp"
+#include "box.hpp"
+
+int main()
+{
+    try
+    {
+        static_assert(sizeof(Coordinates) == 8);
+
+        // Every coordinate with OSM precision survives the fixed point representation exactly
+        char text[32];
+        for(int i = 0; i < 100000; i++)
+        {
+            const long fixed = static_cast<long>(rand()) % 1800000000L - 900000000L;
+            std::snprintf(text, sizeof(text), "%.7f", fixed / 1e7);
+            const double degrees = std::stod(text);
+
+            const Coordinates coordinates(degrees, -degrees);
+            assert(coordinates.getLatitude() == degrees && coordinates.getLongitude() == -degrees);
+            assert(coordinates.getFixedLatitude() == fixed && coordinates.getFixedLongitude() == -fixed);
+            assert(Coordinates::fromFixedPoint(fixed, -fixed).getLatitude() == degrees);
+        }
+
+        const Coordinates parsed("49.0258300, 8.3549300");
+        assert(parsed.getFixedLatitude() == 490258300 && parsed.getFixedLongitude() == 83549300);
+
+        // Values beyond the valid range are clamped instead of overflowing
+        const Coordinates huge(1e300, -1e300);
+        assert(huge.getLatitude() == 180.0 && huge.getLongitude() == -180.0);
+
+        const Box box(Coordinates(49.0, 8.3), Coordinates(49.1, 8.4));
+        assert(box.contains(Coordinates(49.05, 8.35)) && !box.contains(Coordinates(49.1000001, 8.35)));
+        assert(box.getCenter().getFixedLatitude() == 490500000 && box.getCenter().getFixedLongitude() == 83500000);
+
+        // Graph nodes and geometry keep the coordinates of the OSM file
+        const std::string osmFile = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmFile);
+        const Graph &graph = router.getGraph();
+        assert(graph.getNodeCount() > 0);
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(index);
+            const Coordinates &from = edge->getPath().front();
+            assert(from.getFixedLatitude() == edge->from()->getCoordinates().getFixedLatitude());
+            assert(from.getFixedLongitude() == edge->from()->getCoordinates().getFixedLongitude());
+            assert(router.getQuadtree().getBoundary().contains(from));
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
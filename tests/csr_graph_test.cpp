@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+
+#include "router.hpp"
+#include "csrgraph.hpp"
+
+int main()
+{
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+
+        const Graph &graph = router.getGraph();
+        const CsrGraph &csrGraph = router.getCsrGraph();
+
+        assert(csrGraph.getNodeCount() == graph.getNodes().size());
+        assert(csrGraph.getEdgeCount() == graph.getEdges().size());
+        assert(graph.getNodeCount() == graph.getNodes().size());
+        assert(graph.getEdgeCount() == graph.getEdges().size());
+
+        size_t arcCount = 0;
+        for(uint32_t nodeIndex = 0; nodeIndex < csrGraph.getNodeCount(); nodeIndex++)
+        {
+            const Node *node = graph.getNodeByIndex(nodeIndex);
+            assert(node->getIndex() == nodeIndex);
+            assert(graph.getNodeIndex(node->getId()) == nodeIndex);
+            assert(csrGraph.getCoordinates(nodeIndex).getLatitude() == node->getCoordinates().getLatitude());
+            assert(csrGraph.getArcs(nodeIndex).size() == node->edges.size());
+
+            for(const CsrGraph::Arc &arc : csrGraph.getArcs(nodeIndex))
+            {
+                const Edge *edge = graph.getEdgeByIndex(arc.edge);
+                const Node *target = graph.getNodeByIndex(arc.target);
+                assert(edge->getIndex() == arc.edge);
+
+                if(arc.reversed)
+                {
+                    assert(edge->to().get() == node && edge->from().get() == target);
+                }
+                else
+                {
+                    assert(edge->from().get() == node && edge->to().get() == target);
+                }
+                arcCount++;
+            }
+        }
+
+        assert(arcCount == 2 * graph.getEdges().size());
+
+        std::cout << "CSR graph has " << csrGraph.getNodeCount() << " nodes and " << arcCount << " arcs.\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+
+        for(int epoch = 0; epoch < 3; epoch++)
+        {
+            // Jede Epoche mit anderen Gewichten, wie in den Trainingsschleifen
+            router.getWeights().setWeight("highway", "residential", 0.5 * epoch);
+            router.getWeights().setWeight("highway", "track", 2.0 - 0.5 * epoch);
+            router.customizeContractionHierarchy();
+
+            for(int i = 0; i < 100; i++)
+            {
+                uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+                uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+
+                auto edges = router.aStarEdges(startId, goalId, true);
+                auto hierarchyEdges = router.aStarEdges(startId, goalId, true, RoutingMode::ContractionHierarchy);
+
+                double cost = routes.getCost(edges, router.getWeights());
+                double hierarchyCost = routes.getCost(hierarchyEdges, router.getWeights());
+
+                assert(std::abs(cost - hierarchyCost) <= 1e-3 * cost + 1e-6);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
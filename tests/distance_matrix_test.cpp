@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+        SearchContext context;
+
+        std::vector<uint64_t> sourceIds;
+        std::vector<uint64_t> targetIds;
+        for(int i = 0; i < 20; i++) sourceIds.push_back(graph.getNodeByIndex(rand() % graph.getNodeCount())->getId());
+        for(int i = 0; i < 30; i++) targetIds.push_back(graph.getNodeByIndex(rand() % graph.getNodeCount())->getId());
+        targetIds.push_back(targetIds.front());
+
+        for(bool useWeighting : {false, true})
+        {
+            auto begin = std::chrono::steady_clock::now();
+            const DistanceMatrix matrix = router.distanceMatrix(sourceIds, targetIds, useWeighting);
+            auto end = std::chrono::steady_clock::now();
+            std::cout << "Distance matrix " << sourceIds.size() << "x" << targetIds.size() << (useWeighting ? " (weighted)" : "") << " in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+            assert(matrix.sourceCount == sourceIds.size() && matrix.targetCount == targetIds.size());
+
+            // Every entry matches a point-to-point A* query
+            for(uint32_t source = 0; source < matrix.sourceCount; source++)
+            {
+                for(uint32_t target = 0; target < matrix.targetCount; target++)
+                {
+                    auto edges = router.aStarEdges(context, sourceIds[source], targetIds[target], useWeighting);
+                    if(edges.empty())
+                    {
+                        assert(sourceIds[source] == targetIds[target] || std::isinf(matrix.getCost(source, target)));
+                        continue;
+                    }
+
+                    const double cost = useWeighting ? routes.getCost(edges, router.getWeights()) : routes.getLength(edges);
+                    assert(std::abs(matrix.getCost(source, target) - cost) <= 1e-6 * cost + 1e-6);
+                    if(!useWeighting)
+                    {
+                        assert(std::abs(matrix.getLength(source, target) - cost) <= 1e-6 * cost + 1e-6);
+                    }
+                }
+                assert(matrix.getCost(source, matrix.targetCount - 1) == matrix.getCost(source, 0));
+            }
+        }
+
+        // Coordinates snap to phantom nodes; the graph is undirected, so the square matrix is symmetric
+        std::vector<Coordinates> points;
+        for(int i = 0; i < 25; i++)
+        {
+            const Coordinates &a = graph.getNodeByIndex(rand() % graph.getNodeCount())->getCoordinates();
+            const Coordinates &b = graph.getNodeByIndex(rand() % graph.getNodeCount())->getCoordinates();
+            points.emplace_back((a.getLatitude() + b.getLatitude()) / 2, (a.getLongitude() + b.getLongitude()) / 2);
+        }
+
+        const DistanceMatrix parallel = router.distanceMatrix(points, points, true, 4);
+        const DistanceMatrix serial = router.distanceMatrix(points, points, true, 1);
+        assert(parallel.costs == serial.costs && parallel.lengths == serial.lengths);
+
+        for(uint32_t i = 0; i < points.size(); i++)
+        {
+            assert(parallel.getCost(i, i) == 0 && parallel.getLength(i, i) == 0);
+            for(uint32_t j = 0; j < points.size(); j++)
+            {
+                const double cost = parallel.getCost(i, j);
+                assert(std::isinf(cost) == std::isinf(parallel.getCost(j, i)));
+                if(!std::isinf(cost))
+                {
+                    assert(std::abs(cost - parallel.getCost(j, i)) <= 1e-6 * cost + 1e-6);
+                }
+            }
+        }
+
+        std::cout << "Distance matrices match A*.\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "graphsnapshot.hpp"
+#include "router.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        const std::string snapshotPath = (std::filesystem::temp_directory_path() / "graph_snapshot_test.snapshot").string();
+
+        auto begin = std::chrono::steady_clock::now();
+        Router router(osmPath);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "OSM loaded in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+        GraphSnapshot::write(snapshotPath, router.getGraph(), router.getRTree(), router.getBoundary());
+        assert(GraphSnapshot::isSnapshot(snapshotPath));
+        assert(!GraphSnapshot::isSnapshot(osmPath));
+
+        begin = std::chrono::steady_clock::now();
+        Router snapshotRouter(snapshotPath);
+        end = std::chrono::steady_clock::now();
+        std::cout << "Snapshot loaded in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+        // Same nodes, edges, geometry and tags under the same dense indices
+        const Graph &graph = router.getGraph();
+        const Graph &snapshotGraph = snapshotRouter.getGraph();
+        assert(graph.getNodeCount() == snapshotGraph.getNodeCount());
+        assert(graph.getEdgeCount() == snapshotGraph.getEdgeCount());
+
+        for(uint32_t index = 0; index < graph.getNodeCount(); index++)
+        {
+            const Node *node = graph.getNodeByIndex(index);
+            const Node *snapshotNode = snapshotGraph.getNodeByIndex(index);
+            assert(node->getId() == snapshotNode->getId());
+            assert(node->getCoordinates().getLatitude() == snapshotNode->getCoordinates().getLatitude());
+            assert(node->getCoordinates().getLongitude() == snapshotNode->getCoordinates().getLongitude());
+            assert(node->edges.size() == snapshotNode->edges.size());
+        }
+
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(index);
+            const Edge *snapshotEdge = snapshotGraph.getEdgeByIndex(index);
+            assert(edge->getId() == snapshotEdge->getId());
+            assert(edge->getWeight() == snapshotEdge->getWeight());
+            assert(edge->from()->getIndex() == snapshotEdge->from()->getIndex());
+            assert(edge->to()->getIndex() == snapshotEdge->to()->getIndex());
+            assert(edge->getPath().size() == snapshotEdge->getPath().size());
+            assert(edge->getParameters().getParameters() == snapshotEdge->getParameters().getParameters());
+        }
+
+        // The restored R-tree answers nearest-edge queries like the original one, and so does the quadtree built over the
+        // restored boundary
+        assert(snapshotRouter.getRTree().getLevelCount() == router.getRTree().getLevelCount());
+        assert(snapshotRouter.getRTree().getSegmentCount() == router.getRTree().getSegmentCount());
+        for(int i = 0; i < 200; i++)
+        {
+            const Coordinates &a = graph.getNodeByIndex(rand() % graph.getNodeCount())->getCoordinates();
+            const Coordinates &b = graph.getNodeByIndex(rand() % graph.getNodeCount())->getCoordinates();
+            const Coordinates point((a.getLatitude() + b.getLatitude()) / 2, (a.getLongitude() + b.getLongitude()) / 2);
+
+            for(auto [closest, snapshotClosest] : {std::pair(router.getRTree().getClosestEdges(point, 3), snapshotRouter.getRTree().getClosestEdges(point, 3)),
+                                                    std::pair(router.getQuadtree().getClosestEdges(point, 3), snapshotRouter.getQuadtree().getClosestEdges(point, 3))})
+            {
+                assert(closest.size() == snapshotClosest.size());
+                for(size_t j = 0; j < closest.size(); j++)
+                {
+                    assert(closest[j].edge->getIndex() == snapshotClosest[j].edge->getIndex());
+                    assert(closest[j].subwayId == snapshotClosest[j].subwayId);
+                }
+            }
+
+            uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            auto path = router.aStar(startId, goalId);
+            auto snapshotRoute = snapshotRouter.aStar(startId, goalId);
+            assert(path.size() == snapshotRoute.size());
+            for(size_t j = 0; j < path.size(); j++)
+            {
+                assert(std::get<0>(path[j]) == std::get<0>(snapshotRoute[j]));
+            }
+        }
+
+        // A damaged file is rejected
+        {
+            const auto offset = static_cast<std::streamoff>(std::filesystem::file_size(snapshotPath) / 2);
+            std::fstream file(snapshotPath, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekg(offset);
+            const char byte = static_cast<char>(file.get());
+            file.seekp(offset);
+            file.put(static_cast<char>(~byte));
+        }
+        bool rejected = false;
+        try
+        {
+            GraphSnapshot snapshot(snapshotPath);
+        }
+        catch (const std::runtime_error &)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+
+        // So is a file with a valid checksum whose records index past their sections: the value is written at byteOffset
+        // into the given section and the checksum is recomputed
+        auto loadCorrupted = [&](size_t section, size_t byteOffset, uint32_t value)
+        {
+            GraphSnapshot::write(snapshotPath, router.getGraph(), router.getRTree(), router.getBoundary());
+            {
+                std::vector<char> bytes(std::filesystem::file_size(snapshotPath));
+                std::ifstream(snapshotPath, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+                // Header: magic, version, file size, checksum, then (offset, count) per section
+                constexpr size_t checksumOffset = 16;
+                constexpr size_t headerSize = 24 + 11 * 16;
+                uint64_t sectionOffset;
+                std::memcpy(&sectionOffset, bytes.data() + 24 + section * 16, sizeof(sectionOffset));
+
+                std::memcpy(bytes.data() + sectionOffset + byteOffset, &value, sizeof(value));
+
+                uint64_t hash = 14695981039346656037ull;
+                for(size_t offset = headerSize; offset + sizeof(uint64_t) <= bytes.size(); offset += sizeof(uint64_t))
+                {
+                    uint64_t word;
+                    std::memcpy(&word, bytes.data() + offset, sizeof(word));
+                    hash = (hash ^ word) * 1099511628211ull;
+                }
+                std::memcpy(bytes.data() + checksumOffset, &hash, sizeof(hash));
+
+                std::ofstream(snapshotPath, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+            try
+            {
+                GraphSnapshot snapshot(snapshotPath);
+            }
+            catch (const std::runtime_error &e)
+            {
+                return std::string(e.what());
+            }
+            return std::string();
+        };
+
+        // Edges are the second section, the first children of the R-tree nodes the last one
+        assert(loadCorrupted(1, offsetof(GraphSnapshot::EdgeRecord, to), graph.getNodeCount()).find("edge node out of range") != std::string::npos);
+        assert(loadCorrupted(10, 0, 1).find("R-tree child out of range") != std::string::npos);
+
+        std::filesystem::remove(snapshotPath);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <vector>
+
+#include "ingestfilter.hpp"
+#include "router.hpp"
+
+int main()
+{
+    try
+    {
+        // Tag rules
+        IngestFilter filter;
+        assert(filter.matches({{"highway", "residential"}}));
+        assert(!filter.matches({{"building", "yes"}}));
+
+        filter.excludeTag("access", {"private", "no"});
+        assert(filter.matches({{"highway", "service"}, {"access", "yes"}}));
+        assert(!filter.matches({{"highway", "service"}, {"access", "private"}}));
+
+        IngestFilter cycleways;
+        cycleways.clearTagRules();
+        cycleways.requireTag("highway", {"cycleway", "path"});
+        cycleways.setKeptKeys({"highway", "surface"});
+        assert(cycleways.matches({{"highway", "path"}}));
+        assert(!cycleways.matches({{"highway", "primary"}}));
+        const std::vector<std::string> decodedKeys = filter.getDecodedKeys();
+        assert((decodedKeys == std::vector<std::string>{"highway", "access"}));
+
+        // Area
+        IngestFilter area;
+        assert(!area.hasArea() && area.contains(Coordinates(10.0, 20.0)));
+        area.setPolygon({Coordinates(0.0, 0.0), Coordinates(0.0, 2.0), Coordinates(2.0, 2.0), Coordinates(1.0, 1.0), Coordinates(2.0, 0.0)});
+        assert(area.hasArea());
+        assert(area.contains(Coordinates(0.5, 1.0)));
+        assert(area.contains(Coordinates(1.5, 1.8)));
+        assert(!area.contains(Coordinates(1.5, 1.0)));
+        assert(!area.contains(Coordinates(3.0, 1.0)));
+        area.setBoundingBox(Box(Coordinates(0.0, 0.0), Coordinates(1.0, 1.0)));
+        assert(area.contains(Coordinates(0.5, 0.9)));
+        assert(!area.contains(Coordinates(0.5, 1.5)));
+
+        // The test map, unfiltered and restricted
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        const Graph &graph = router.getGraph();
+
+        IngestFilter noFootways;
+        noFootways.excludeTag("highway", {"footway", "path", "steps"});
+        noFootways.setKeptKeys({"highway", "surface"});
+        Router roadRouter(osmPath, "", noFootways);
+        assert(roadRouter.getGraph().getEdgeCount() > 0);
+        for(uint32_t index = 0; index < roadRouter.getGraph().getEdgeCount(); index++)
+        {
+            const Parameters &parameters = roadRouter.getGraph().getEdgeByIndex(index)->getParameters();
+            const std::string highway = parameters.getParameter("highway");
+            assert(highway != "footway" && highway != "path" && highway != "steps");
+            assert(!parameters.getParameter("surface").empty());
+        }
+
+        // Central quarter of the map; ways leaving it are cut at the border
+        const Box boundary = router.getQuadtree().getBoundary();
+        const Coordinates center = boundary.getCenter();
+        const double latitudeSpan = boundary.getMaxLatitudeLongitude().getLatitude() - boundary.getMinLatitudeLongitude().getLatitude();
+        const double longitudeSpan = boundary.getMaxLatitudeLongitude().getLongitude() - boundary.getMinLatitudeLongitude().getLongitude();
+        const Box box(Coordinates(center.getLatitude() - latitudeSpan / 4, center.getLongitude() - longitudeSpan / 4),
+                      Coordinates(center.getLatitude() + latitudeSpan / 4, center.getLongitude() + longitudeSpan / 4));
+
+        IngestFilter boxFilter;
+        boxFilter.setBoundingBox(box);
+        Router boxRouter(osmPath, "", boxFilter);
+        const Graph &boxGraph = boxRouter.getGraph();
+        std::cout << "Full map: " << graph.getEdgeCount() << " edges, bounding box: " << boxGraph.getEdgeCount() << " edges\n";
+        assert(boxGraph.getEdgeCount() > 0);
+        assert(boxGraph.getEdgeCount() < graph.getEdgeCount());
+        for(uint32_t index = 0; index < boxGraph.getEdgeCount(); index++)
+        {
+            for(const Coordinates &point : boxGraph.getEdgeByIndex(index)->getPath())
+            {
+                assert(box.contains(point));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
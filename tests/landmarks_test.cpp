@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+        SearchContext context;
+
+        router.prepareLandmarks(16, false, LandmarkSelection::Farthest);
+        router.prepareLandmarks(16, true, LandmarkSelection::Avoid);
+        assert(router.getLandmarks(true)->isWeighted());
+
+        // Fixed-point tables give the same bounds up to their resolution
+        Landmarks<uint32_t> fixedLandmarks(graph, router.getCsrGraph(), &router.getWeights(), 16, LandmarkSelection::Avoid);
+        const Landmarks<float> &landmarks = *router.getLandmarks(true);
+        assert(fixedLandmarks.getLandmarkCount() == landmarks.getLandmarkCount());
+
+        auto countSettled = [&context]()
+        {
+            size_t settled = 0;
+            for(uint32_t nodeIndex = 0; nodeIndex < context.getOverlay().getNodeCount(); nodeIndex++)
+            {
+                settled += context.isSettled(nodeIndex);
+            }
+            return settled;
+        };
+
+        size_t settledAStar = 0;
+        size_t settledLandmarks = 0;
+
+        for(int i = 0; i < 200; i++)
+        {
+            const uint32_t startIndex = rand() % graph.getNodeCount();
+            const uint32_t goalIndex = rand() % graph.getNodeCount();
+            const uint64_t startId = graph.getNodeByIndex(startIndex)->getId();
+            const uint64_t goalId = graph.getNodeByIndex(goalIndex)->getId();
+            bool useWeighting = i % 2;
+
+            auto path = router.aStar(context, startId, goalId, 0, useWeighting);
+            if(useWeighting) settledAStar += countSettled();
+            auto edges = router.aStarEdges(context, startId, goalId, useWeighting);
+
+            auto landmarkPath = router.aStar(context, startId, goalId, 0, useWeighting, RoutingMode::ALT);
+            if(useWeighting) settledLandmarks += countSettled();
+            auto landmarkEdges = router.aStarEdges(context, startId, goalId, useWeighting, RoutingMode::ALT);
+
+            double cost = useWeighting ? routes.getCost(edges, router.getWeights()) : routes.getLength(edges);
+            double landmarkCost = useWeighting ? routes.getCost(landmarkEdges, router.getWeights()) : routes.getLength(landmarkEdges);
+            assert(std::abs(cost - landmarkCost) <= 1e-3 * cost + 1e-6);
+            assert(path.empty() == landmarkPath.empty());
+
+            if(useWeighting && !edges.empty())
+            {
+                std::vector<double> startDistances(landmarks.getLandmarkCount());
+                landmarks.getDistances(startIndex, startDistances.data());
+                const double lowerBound = landmarks.getLowerBound(goalIndex, startDistances.data());
+                assert(lowerBound <= cost + 1e-6);
+
+                fixedLandmarks.getDistances(startIndex, startDistances.data());
+                assert(std::abs(fixedLandmarks.getLowerBound(goalIndex, startDistances.data()) - lowerBound) < 0.1);
+            }
+        }
+
+        std::cout << "Settled nodes with weighting: A* " << settledAStar << ", ALT " << settledLandmarks << "\n";
+        assert(settledLandmarks < settledAStar);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <vector>
+
+#include "osmxmlscanner.hpp"
+
+namespace
+{
+    // Concatenates the blocks of all chunks
+    OsmBlock scanAll(const OsmXmlScanner &scanner, size_t chunkSize)
+    {
+        OsmBlock result;
+        const std::vector<size_t> offsets = scanner.getChunkOffsets(chunkSize);
+        for(size_t chunk = 0; chunk + 1 < offsets.size(); chunk++)
+        {
+            OsmBlock block = scanner.scanChunk(offsets[chunk], offsets[chunk + 1]);
+            result.nodes.insert(result.nodes.end(), block.nodes.begin(), block.nodes.end());
+            result.ways.insert(result.ways.end(), block.ways.begin(), block.ways.end());
+        }
+        return result;
+    }
+
+    bool sameBlock(const OsmBlock &a, const OsmBlock &b)
+    {
+        if(a.nodes.size() != b.nodes.size() || a.ways.size() != b.ways.size()) return false;
+        for(size_t index = 0; index < a.nodes.size(); index++)
+        {
+            if(a.nodes[index].id != b.nodes[index].id || a.nodes[index].latitude != b.nodes[index].latitude || a.nodes[index].longitude != b.nodes[index].longitude) return false;
+        }
+        for(size_t index = 0; index < a.ways.size(); index++)
+        {
+            if(a.ways[index].id != b.ways[index].id || a.ways[index].nodeRefs != b.ways[index].nodeRefs || a.ways[index].tags != b.ways[index].tags) return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    try
+    {
+        // Quirks of real exports: declaration, comments, tagged nodes, single quotes, entities, relations
+        const std::string xmlPath = (std::filesystem::temp_directory_path() / "osm_xml_scanner_test.osm").string();
+        {
+            std::ofstream file(xmlPath);
+            file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 << "<osm version=\"0.6\" generator=\"test\">\n"
+                 << " <bounds minlat=\"49.0\" minlon=\"8.3\" maxlat=\"49.1\" maxlon=\"8.4\"/>\n"
+                 << " <!-- <node id=\"99\" lat=\"0\" lon=\"0\"/> -->\n"
+                 << " <node id=\"1\" lat=\"49.0512345\" lon=\"8.3712345\" version=\"2\"/>\n"
+                 << " <node id='2' visible='true' lat='49.06' lon='8.38'>\n"
+                 << "  <tag k=\"highway\" v=\"crossing\"/>\n"
+                 << " </node>\n"
+                 << " <node id=\"-3\" lat=\"-0.5\" lon=\"1e-3\" />\n"
+                 << " <node id=\"4\" lat=\"invalid\" lon=\"8.39\"/>\n"
+                 << " <way id=\"10\">\n"
+                 << "  <nd ref=\"1\"/>\n"
+                 << "  <nd ref=\"2\"/>\n"
+                 << "  <tag k=\"name\" v=\"Hauptstra&#223;e\"/>\n"
+                 << "  <tag k=\"highway\" v=\"a &amp; b &lt;&gt;&quot;&apos;\"/>\n"
+                 << " </way>\n"
+                 << " <way id=\"11\"/>\n"
+                 << " <relation id=\"20\">\n"
+                 << "  <member type=\"way\" ref=\"10\" role=\"\"/>\n"
+                 << "  <tag k=\"highway\" v=\"pedestrian\"/>\n"
+                 << " </relation>\n"
+                 << " <way id=\"12\"><nd ref=\"2\"/><nd ref=\"-3\"/><tag k=\"highway\" v=\"path\"/></way>\n"
+                 << "</osm>\n";
+        }
+
+        OsmXmlScanner scanner(xmlPath, {"highway"});
+        const OsmBlock block = scanAll(scanner, 1 << 20);
+
+        assert(block.nodes.size() == 3);
+        assert(block.nodes[0].id == 1 && block.nodes[0].latitude == 49.0512345 && block.nodes[0].longitude == 8.3712345);
+        assert(block.nodes[1].id == 2 && block.nodes[1].latitude == 49.06 && block.nodes[1].longitude == 8.38);
+        assert(block.nodes[2].id == static_cast<uint64_t>(-3) && block.nodes[2].latitude == -0.5 && block.nodes[2].longitude == 0.001);
+
+        assert(block.ways.size() == 3);
+        assert(block.ways[0].id == 10);
+        assert((block.ways[0].nodeRefs == std::vector<uint64_t>{1, 2}));
+        assert(block.ways[0].tags.size() == 1);
+        assert(block.ways[0].tags[0].first == "highway" && block.ways[0].tags[0].second == "a & b <>\"'");
+        assert(block.ways[1].id == 11 && block.ways[1].nodeRefs.empty() && block.ways[1].tags.empty());
+        assert(block.ways[2].id == 12);
+        assert((block.ways[2].nodeRefs == std::vector<uint64_t>{2, static_cast<uint64_t>(-3)}));
+        assert(block.ways[2].tags[0].second == "path");
+
+        // Tiny chunks split between every element and must give the same result
+        const std::vector<size_t> offsets = scanner.getChunkOffsets(1);
+        assert(offsets.size() > 5);
+        assert(sameBlock(block, scanAll(scanner, 1)));
+
+        std::filesystem::remove(xmlPath);
+
+        // The test map, whole and in chunks
+        OsmXmlScanner mapScanner(std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm", {"highway"});
+        const OsmBlock whole = scanAll(mapScanner, SIZE_MAX);
+        assert(!whole.nodes.empty());
+        assert(!whole.ways.empty());
+        assert(sameBlock(whole, scanAll(mapScanner, 64 * 1024)));
+
+        OsmBlock parallel;
+        mapScanner.read([&](OsmBlock &&chunk)
+        {
+            parallel.nodes.insert(parallel.nodes.end(), chunk.nodes.begin(), chunk.nodes.end());
+            parallel.ways.insert(parallel.ways.end(), chunk.ways.begin(), chunk.ways.end());
+        }, 4);
+        assert(sameBlock(whole, parallel));
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
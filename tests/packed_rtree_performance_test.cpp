@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "router.hpp"
+
+#include "packedrtree.hpp"
+#include "quadtree.hpp"
+
+Coordinates randomCoordinateGenerator()
+{
+    double lat = 47.5338000528 + static_cast<double>(rand()) / (static_cast<double>(RAND_MAX/(49.7913749328 - 47.5338000528)));
+    double lon = 7.5113934084 + static_cast<double>(rand()) / (static_cast<double>(RAND_MAX/(10.4918239143 - 7.5113934084)));
+    return Coordinates(lat, lon);
+}
+
+// Same workload as quadtree_performance_test, run against both indexes
+int main()
+{
+    srand(0);
+
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/bw_min.osm";
+
+        Router router(osmPath);
+        Quadtree &quadtree = router.getQuadtree();
+        const PackedRTree &rtree = router.getRTree();
+        Graph &graph = router.getGraph();
+
+        const uint32_t testCount = 10000;
+        std::vector<Coordinates> testPoints;
+        for(size_t i = 0; i < testCount; i++)
+        {
+            testPoints.push_back(randomCoordinateGenerator());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        double quadtreeDistance = 0;
+        for(const Coordinates &testPoint : testPoints)
+        {
+            quadtreeDistance += quadtree.getClosestEdges(testPoint, 3).back().distance;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> quadtreeDuration = end - start;
+
+        start = std::chrono::high_resolution_clock::now();
+        double rtreeDistance = 0;
+        for(const Coordinates &testPoint : testPoints)
+        {
+            rtreeDistance += rtree.getClosestEdges(testPoint, 3).back().distance;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> rtreeDuration = end - start;
+
+        std::cout << "Quadtree: " << testCount << " nearest edge searches in " << quadtreeDuration.count() << " ms, "
+                  << (testCount / (quadtreeDuration.count() / 1000.0)) << " points/s\n";
+        std::cout << "R-tree:   " << testCount << " nearest edge searches in " << rtreeDuration.count() << " ms, "
+                  << (testCount / (rtreeDuration.count() / 1000.0)) << " points/s\n";
+        std::cout << "Speedup: " << quadtreeDuration.count() / rtreeDuration.count() << "x\n";
+        std::cout << "Graph has " << graph.getEdges().size() << " edges, R-tree has " << rtree.getSegmentCount() << " segments in " << rtree.getLevelCount() << " levels.\n";
+
+        // Far outside the map the Quadtree may miss a segment by a few meters, so the sums only roughly agree
+        std::cout << "Mean distance of the third closest segment: Quadtree " << quadtreeDistance / testCount << " m, R-tree " << rtreeDistance / testCount << " m\n";
+        if(rtreeDistance > quadtreeDistance * (1 + 1e-6))
+        {
+            std::cerr << "Fehler im Test: R-tree found farther segments than the Quadtree\n";
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "router.hpp"
+#include "library.hpp"
+#include "packedrtree.hpp"
+#include "quadtree.hpp"
+
+Coordinates randomCoordinateGenerator(const Box &box)
+{
+    double lat = box.getMinLatitudeLongitude().getLatitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLatitude() - box.getMinLatitudeLongitude().getLatitude());
+    double lon = box.getMinLatitudeLongitude().getLongitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLongitude() - box.getMinLatitudeLongitude().getLongitude());
+    return Coordinates(lat, lon);
+}
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        const Graph &graph = router.getGraph();
+        const PackedRTree &rtree = router.getRTree();
+        Quadtree &quadtree = router.getQuadtree();
+
+        // Every segment of the graph is indexed once
+        size_t segmentCount = 0;
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            segmentCount += graph.getEdgeByIndex(index)->getPath().size() - 1;
+        }
+        assert(rtree.getSegmentCount() == segmentCount);
+        assert(rtree.getBoundary().contains(graph.getNodeByIndex(0)->getCoordinates()));
+        std::cout << "R-tree: " << segmentCount << " segments, " << rtree.getLevelCount() << " levels\n";
+
+        // Same distances as the Quadtree for points inside and around the map
+        for(int i = 0; i < 1000; i++)
+        {
+            const Coordinates point = randomCoordinateGenerator(quadtree.getBoundary());
+            for(uint8_t resultCount : {1, 3, 10})
+            {
+                for(bool multipleSegments : {true, false})
+                {
+                    auto expected = quadtree.getClosestEdges(point, resultCount, multipleSegments);
+                    auto closestEdges = rtree.getClosestEdges(point, resultCount, multipleSegments);
+                    assert(closestEdges.size() == expected.size());
+                    for(size_t result = 0; result < closestEdges.size(); result++)
+                    {
+                        assert(closestEdges[result].distance == expected[result].distance);
+                        const Edge *edge = closestEdges[result].edge;
+                        const uint8_t subwayId = closestEdges[result].subwayId;
+                        assert(HelperFunctions::distancePointToSegment(point, edge->getPath()[subwayId], edge->getPath()[subwayId + 1]) == closestEdges[result].distance);
+                    }
+                }
+            }
+        }
+
+        // Points right next to the roads, where the planar leaf kernel has to tell nearly equal segments apart
+        for(int i = 0; i < 300; i++)
+        {
+            const auto path = graph.getEdgeByIndex(rand() % graph.getEdgeCount())->getPath();
+            const Coordinates &vertex = path[rand() % path.size()];
+            const double offset = (i % 2 == 0 ? 1e-6 : 1e-4) * (static_cast<double>(rand()) / RAND_MAX - 0.5);
+            const Coordinates point(vertex.getLatitude() + offset, vertex.getLongitude() - offset);
+
+            std::vector<double> distances;
+            for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+            {
+                const auto segments = graph.getEdgeByIndex(index)->getPath();
+                for(size_t subwayId = 0; subwayId + 1 < segments.size(); subwayId++)
+                {
+                    distances.push_back(HelperFunctions::distancePointToSegment(point, segments[subwayId], segments[subwayId + 1]));
+                }
+            }
+            std::partial_sort(distances.begin(), distances.begin() + 3, distances.end());
+
+            auto closestEdges = rtree.getClosestEdges(point, 3);
+            for(size_t result = 0; result < 3; result++)
+            {
+                assert(closestEdges[result].distance == distances[result]);
+            }
+        }
+
+        // Segments of one edge appear only once without multipleSegments
+        const Coordinates center = quadtree.getBoundary().getCenter();
+        auto closestEdges = rtree.getClosestEdges(center, 20, false);
+        for(size_t a = 0; a < closestEdges.size(); a++)
+        {
+            for(size_t b = a + 1; b < closestEdges.size(); b++)
+            {
+                assert(closestEdges[a].edge != closestEdges[b].edge);
+            }
+        }
+
+        // The router snaps to the segment the index returns
+        const auto [edgeId, segmentIndex] = router.getClosestSegment(center);
+        assert(edgeId == rtree.getClosestEdges(center)[0].edge->getId());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
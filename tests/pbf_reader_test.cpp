@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <zlib.h>
+
+#include "library.hpp"
+#include "osmnode.hpp"
+#include "osmway.hpp"
+#include "router.hpp"
+
+// Minimal protobuf encoder, just enough to write the OSM PBF messages read by PbfReader
+namespace
+{
+    void writeVarint(std::string &out, uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+    void writeVarintField(std::string &out, uint32_t field, uint64_t value)
+    {
+        writeVarint(out, field << 3);
+        writeVarint(out, value);
+    }
+
+    void writeBytesField(std::string &out, uint32_t field, const std::string &bytes)
+    {
+        writeVarint(out, (field << 3) | 2);
+        writeVarint(out, bytes.size());
+        out += bytes;
+    }
+
+    void writePackedField(std::string &out, uint32_t field, const std::vector<int64_t> &values, bool useZigzag)
+    {
+        std::string packed;
+        for(int64_t value : values) writeVarint(packed, useZigzag ? zigzag(value) : static_cast<uint64_t>(value));
+        writeBytesField(out, field, packed);
+    }
+
+    void writeBlob(std::ofstream &file, const std::string &type, const std::string &message, bool compress)
+    {
+        std::string blob;
+        if(compress)
+        {
+            uLongf size = compressBound(message.size());
+            std::string compressed(size, '\0');
+            ::compress(reinterpret_cast<Bytef *>(compressed.data()), &size, reinterpret_cast<const Bytef *>(message.data()), message.size());
+            compressed.resize(size);
+            writeVarintField(blob, 2, message.size());
+            writeBytesField(blob, 3, compressed);
+        }
+        else
+        {
+            writeBytesField(blob, 1, message);
+        }
+
+        std::string header;
+        writeBytesField(header, 1, type);
+        writeVarintField(header, 3, blob.size());
+
+        const uint32_t size = static_cast<uint32_t>(header.size());
+        const char sizeBytes[4] = {static_cast<char>(size >> 24), static_cast<char>(size >> 16), static_cast<char>(size >> 8), static_cast<char>(size)};
+        file.write(sizeBytes, 4);
+        file << header << blob;
+    }
+
+    int64_t toFixed(double degrees) { return std::llround(degrees * 1e7); }
+}
+
+int main()
+{
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        const std::string pbfPath = (std::filesystem::temp_directory_path() / "pbf_reader_test.osm.pbf").string();
+
+        // Encode the routing nodes and highways of the test map as PBF
+        {
+            ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> nodes;
+            ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> ways;
+            HelperFunctions::readOSMFile(osmPath, nodes, ways);
+
+            std::vector<const OsmNode *> sortedNodes;
+            for(const auto &[id, node] : nodes) sortedNodes.push_back(node.get());
+            std::sort(sortedNodes.begin(), sortedNodes.end(), [](const OsmNode *a, const OsmNode *b) { return a->getId() < b->getId(); });
+
+            std::ofstream file(pbfPath, std::ios::binary);
+
+            std::string header;
+            writeBytesField(header, 4, "OsmSchema-V0.6");
+            writeBytesField(header, 4, "DenseNodes");
+            writeBlob(file, "OSMHeader", header, true);
+
+            // Dense node blocks of 1000 nodes; the first node of each block is written as a plain node
+            for(size_t begin = 0; begin < sortedNodes.size(); begin += 1000)
+            {
+                const size_t end = std::min(sortedNodes.size(), begin + 1000);
+                std::string plainNode;
+                writeVarintField(plainNode, 1, zigzag(static_cast<int64_t>(sortedNodes[begin]->getId())));
+                writeVarintField(plainNode, 8, zigzag(toFixed(sortedNodes[begin]->getCoordinates().getLatitude())));
+                writeVarintField(plainNode, 9, zigzag(toFixed(sortedNodes[begin]->getCoordinates().getLongitude())));
+
+                std::vector<int64_t> ids, lats, lons;
+                int64_t lastId = 0, lastLat = 0, lastLon = 0;
+                for(size_t index = begin + 1; index < end; index++)
+                {
+                    const int64_t id = static_cast<int64_t>(sortedNodes[index]->getId());
+                    const int64_t lat = toFixed(sortedNodes[index]->getCoordinates().getLatitude());
+                    const int64_t lon = toFixed(sortedNodes[index]->getCoordinates().getLongitude());
+                    ids.push_back(id - lastId);
+                    lats.push_back(lat - lastLat);
+                    lons.push_back(lon - lastLon);
+                    lastId = id;
+                    lastLat = lat;
+                    lastLon = lon;
+                }
+                std::string dense;
+                writePackedField(dense, 1, ids, true);
+                writePackedField(dense, 8, lats, true);
+                writePackedField(dense, 9, lons, true);
+
+                std::string group;
+                writeBytesField(group, 1, plainNode);
+                writeBytesField(group, 2, dense);
+
+                std::string stringTable;
+                writeBytesField(stringTable, 1, "");
+                std::string block;
+                writeBytesField(block, 1, stringTable);
+                writeBytesField(block, 2, group);
+                writeBlob(file, "OSMData", block, begin % 2000 == 0);
+            }
+
+            // Ways in one block; string 0 is empty by convention. A building way must be ignored.
+            std::vector<std::string> strings{"", "highway", "building", "yes"};
+            auto stringIndex = [&](const std::string &string)
+            {
+                auto it = std::find(strings.begin(), strings.end(), string);
+                if(it != strings.end()) return static_cast<int64_t>(it - strings.begin());
+                strings.push_back(string);
+                return static_cast<int64_t>(strings.size() - 1);
+            };
+
+            std::string group;
+            for(const auto &[id, way] : ways)
+            {
+                std::vector<int64_t> refs;
+                int64_t lastRef = 0;
+                for(const auto &node : way->getNodes())
+                {
+                    refs.push_back(static_cast<int64_t>(node->getId()) - lastRef);
+                    lastRef = static_cast<int64_t>(node->getId());
+                }
+
+                std::string message;
+                writeVarintField(message, 1, id);
+                writePackedField(message, 2, {stringIndex("highway")}, false);
+                writePackedField(message, 3, {stringIndex(way->getParameters().getParameter("highway"))}, false);
+                writePackedField(message, 8, refs, true);
+                writeBytesField(group, 3, message);
+            }
+
+            std::string building;
+            writeVarintField(building, 1, 1);
+            writePackedField(building, 2, {2}, false);
+            writePackedField(building, 3, {3}, false);
+            writePackedField(building, 8, {static_cast<int64_t>(sortedNodes[0]->getId()), 1}, true);
+            writeBytesField(group, 3, building);
+
+            std::string stringTable;
+            for(const std::string &string : strings) writeBytesField(stringTable, 1, string);
+            std::string block;
+            writeBytesField(block, 1, stringTable);
+            writeBytesField(block, 2, group);
+            writeBlob(file, "OSMData", block, true);
+        }
+
+        Router router(osmPath);
+
+        auto begin = std::chrono::steady_clock::now();
+        Router pbfRouter(pbfPath);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "PBF loaded in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+        // Same graph as from the XML file
+        const Graph &graph = router.getGraph();
+        const Graph &pbfGraph = pbfRouter.getGraph();
+        assert(graph.getNodeCount() == pbfGraph.getNodeCount());
+        assert(graph.getEdgeCount() == pbfGraph.getEdgeCount());
+
+        for(uint32_t index = 0; index < graph.getNodeCount(); index++)
+        {
+            const Node *node = graph.getNodeByIndex(index);
+            const Node *pbfNode = pbfGraph.getNodeByIndex(index);
+            assert(node->getId() == pbfNode->getId());
+            assert(std::abs(node->getCoordinates().getLatitude() - pbfNode->getCoordinates().getLatitude()) < 1e-9);
+            assert(std::abs(node->getCoordinates().getLongitude() - pbfNode->getCoordinates().getLongitude()) < 1e-9);
+        }
+
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(index);
+            const Edge *pbfEdge = pbfGraph.getEdgeByIndex(index);
+            assert(edge->getId() == pbfEdge->getId());
+            assert(edge->from()->getId() == pbfEdge->from()->getId());
+            assert(edge->to()->getId() == pbfEdge->to()->getId());
+            assert(edge->getPath().size() == pbfEdge->getPath().size());
+            assert(std::abs(edge->getWeight() - pbfEdge->getWeight()) < 1e-6);
+            assert(edge->getParameters().getParameters() == pbfEdge->getParameters().getParameters());
+        }
+
+        std::filesystem::remove(pbfPath);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
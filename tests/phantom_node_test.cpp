@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "router.hpp"
+#include "library.hpp"
+#include "searchcontext.hpp"
+
+double pathLength(const std::vector<std::tuple<uint64_t, Coordinates>> &path)
+{
+    double length = 0;
+    for(size_t i = 1; i < path.size(); i++)
+    {
+        length += HelperFunctions::haversine(std::get<1>(path[i - 1]), std::get<1>(path[i]));
+    }
+    return length;
+}
+
+Coordinates randomCoordinateGenerator(const Box &box)
+{
+    double lat = box.getMinLatitudeLongitude().getLatitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLatitude() - box.getMinLatitudeLongitude().getLatitude());
+    double lon = box.getMinLatitudeLongitude().getLongitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLongitude() - box.getMinLatitudeLongitude().getLongitude());
+    return Coordinates(lat, lon);
+}
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        Graph &graph = router.getGraph();
+
+        const size_t nodeCount = graph.getNodes().size();
+        const size_t edgeCount = graph.getEdges().size();
+
+        SearchContext context;
+        for(int i = 0; i < 100; i++)
+        {
+            Coordinates start = randomCoordinateGenerator(router.getQuadtree().getBoundary());
+            Coordinates goal = randomCoordinateGenerator(router.getQuadtree().getBoundary());
+
+            // Phantom nodes must not touch the shared graph
+            auto phantomPath = router.aStar(context, start, goal);
+            assert(graph.getNodes().size() == nodeCount && graph.getEdges().size() == edgeCount);
+            assert(graph.getSplitItemIds().empty());
+
+            // Reference: split the graph explicitly
+            auto [closestStartPoint, closestStartEdgeId, startSegment] = router.getEdgeSplit(start);
+            uint64_t newNodeIdStart = graph.addSplit(closestStartPoint, closestStartEdgeId, startSegment);
+            auto [closestEndPoint, closestEndEdgeId, endSegment] = router.getEdgeSplit(goal);
+            uint64_t newNodeIdEnd = graph.addSplit(closestEndPoint, closestEndEdgeId, endSegment);
+
+            auto splitPath = router.aStar(newNodeIdStart, newNodeIdEnd);
+            graph.removeSplitItems();
+
+            assert(phantomPath.empty() == splitPath.empty());
+            assert(std::abs(pathLength(phantomPath) - pathLength(splitPath)) < 0.01);
+            assert(!router.aStarEdges(context, start, goal).empty() || phantomPath.size() <= 2);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
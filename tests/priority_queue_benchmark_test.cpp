@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "router.hpp"
+#include "routes.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath, "weightsnew.csv");
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+        SearchContext context;
+
+        const uint32_t testCount = 1000;
+        std::vector<std::pair<uint64_t, uint64_t>> queries;
+        for(uint32_t i = 0; i < testCount; i++)
+        {
+            queries.emplace_back(graph.getNodeByIndex(rand() % graph.getNodeCount())->getId(), graph.getNodeByIndex(rand() % graph.getNodeCount())->getId());
+        }
+
+        const std::pair<PriorityQueue, std::string> priorityQueues[] = {
+            {PriorityQueue::BinaryHeap, "binary heap"},
+            {PriorityQueue::QuaternaryHeap, "4-ary heap"},
+            {PriorityQueue::RadixHeap, "radix heap"}
+        };
+
+        std::vector<double> expectedCosts;
+        for(const auto &[priorityQueue, name] : priorityQueues)
+        {
+            router.setPriorityQueue(priorityQueue);
+
+            std::vector<double> costs;
+            auto start = std::chrono::high_resolution_clock::now();
+
+            for(const auto &[startId, goalId] : queries)
+            {
+                auto path = router.aStar(context, startId, goalId, 0, true);
+                costs.push_back(path.empty() ? -1 : context.getCost(graph.getNodeIndex(goalId)));
+            }
+
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> duration = end - start;
+            std::cout << "Time taken for " << testCount << " weighted A* queries with " << name << ": " << duration.count() << " ms\n";
+
+            if(expectedCosts.empty())
+            {
+                expectedCosts = costs;
+                continue;
+            }
+            for(uint32_t i = 0; i < testCount; i++)
+            {
+                assert(std::abs(costs[i] - expectedCosts[i]) <= 1e-3 * expectedCosts[i] + 1e-2);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
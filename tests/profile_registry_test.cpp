@@ -0,0 +1,108 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "router.hpp"
+#include "routes.hpp"
+#include "weights.hpp"
+
+int main()
+{
+    try
+    {
+        const std::string osmFile = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmFile, "weightsnew.csv");
+        Routes routes(router);
+
+        {
+            std::ofstream file("jogging_profile.csv");
+            file << "highway,residential,2.5\nhighway,footway,0\nhighway,track,0.2\nhighway,primary,4\n";
+        }
+        const CompiledProfile &jogging = router.addProfile("jogging", "jogging_profile.csv");
+        const CompiledProfile &distance = router.getProfile(Router::DISTANCE_PROFILE);
+        const CompiledProfile &standard = router.getProfile(Router::DEFAULT_PROFILE);
+
+        assert(router.getProfileNames() == std::vector<std::string>({Router::DISTANCE_PROFILE, Router::DEFAULT_PROFILE, "jogging"}));
+        assert(router.hasProfile("jogging") && !router.hasProfile("cycling"));
+        assert(&router.getProfile("jogging") == &jogging && jogging.getWeights() == &router.getWeights("jogging"));
+
+        bool threw = false;
+        try { router.getProfile("cycling"); } catch(const std::out_of_range &) { threw = true; }
+        assert(threw);
+        threw = false;
+        try { router.addProfile("jogging", "jogging_profile.csv"); } catch(const std::invalid_argument &) { threw = true; }
+        assert(threw);
+
+        // Every profile routes over the same graph with its own costs
+        const Graph &graph = router.getGraph();
+        SearchContext context;
+        size_t differentRoutes = 0;
+        for(int i = 0; i < 50; i++)
+        {
+            const uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            const uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+
+            auto distanceEdges = router.aStarEdges(context, startId, goalId, distance);
+            auto standardEdges = router.aStarEdges(context, startId, goalId, standard);
+            auto joggingEdges = router.aStarEdges(context, startId, goalId, jogging);
+            if(distanceEdges.empty())
+                continue;
+
+            // The boolean overloads keep selecting the distance and default profiles
+            assert(routes.getLength(router.aStarEdges(context, startId, goalId, false)) == routes.getLength(distanceEdges));
+            assert(routes.getCost(router.aStarEdges(context, startId, goalId, true), router.getWeights()) == routes.getCost(standardEdges, router.getWeights()));
+
+            // Each route is optimal for its own profile
+            const Weights &joggingWeights = router.getWeights("jogging");
+            const double joggingCost = routes.getCost(joggingEdges, joggingWeights);
+            assert(joggingCost <= routes.getCost(standardEdges, joggingWeights) * (1 + 1e-6) + 1e-6);
+            assert(joggingCost <= routes.getCost(distanceEdges, joggingWeights) * (1 + 1e-6) + 1e-6);
+            assert(routes.getLength(distanceEdges) <= routes.getLength(joggingEdges) * (1 + 1e-6) + 1e-6);
+
+            differentRoutes += routes.getJaccardCoefficient(joggingEdges, standardEdges) < 1.0;
+        }
+        std::cout << differentRoutes << " of 50 jogging routes differ from the default profile\n";
+
+        // Weight changes stay within their profile
+        const std::vector<float> standardCosts(standard.getCosts().begin(), standard.getCosts().end());
+        router.getWeights("jogging").setWeight("highway", "residential", 10.0);
+        const uint64_t startId = graph.getNodeByIndex(0)->getId();
+        const uint64_t goalId = graph.getNodeByIndex(graph.getNodeCount() - 1)->getId();
+        router.aStarEdges(context, startId, goalId, jogging);
+        router.aStarEdges(context, startId, goalId, standard);
+        assert(std::equal(standardCosts.begin(), standardCosts.end(), standard.getCosts().begin()));
+
+        // Hierarchies and distance matrices are prepared and queried per profile
+        router.customizeContractionHierarchy(jogging);
+        assert(router.getContractionHierarchy(jogging) != nullptr && router.getContractionHierarchy(true) == nullptr);
+
+        std::vector<uint64_t> nodeIds;
+        for(int i = 0; i < 10; i++) nodeIds.push_back(graph.getNodeByIndex(rand() % graph.getNodeCount())->getId());
+        const DistanceMatrix matrix = router.distanceMatrix(nodeIds, nodeIds, jogging);
+        for(uint32_t source = 0; source < nodeIds.size(); source++)
+        {
+            for(uint32_t target = 0; target < nodeIds.size(); target++)
+            {
+                auto edges = router.aStarEdges(context, nodeIds[source], nodeIds[target], jogging);
+                auto hierarchyEdges = router.aStarEdges(context, nodeIds[source], nodeIds[target], jogging, RoutingMode::ContractionHierarchy);
+                if(edges.empty())
+                    continue;
+
+                const double cost = routes.getCost(edges, router.getWeights("jogging"));
+                assert(std::abs(matrix.getCost(source, target) - cost) <= 1e-6 * cost + 1e-6);
+                assert(std::abs(routes.getCost(hierarchyEdges, router.getWeights("jogging")) - cost) <= 1e-3 * cost + 1e-6);
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -32,11 +32,13 @@ int main()
 
         const uint32_t testCount = 10000;
 
-        for(int i = 0; i < testCount; i++)
+        uint32_t visitedNodes = 0;
+
+        for(uint32_t i = 0; i < testCount; i++)
         {
             Coordinates testPoint = randomCoordinateGenerator();
 
-            auto closestEdges = quadtree.getClosestEdges(testPoint, 3);
+            auto closestEdges = quadtree.getClosestEdges(testPoint, 3, true, &visitedNodes);
             //std::cout << "Closest edges to point " << testPoint << ":\n";
             //for(const auto &ce : closestEdges)
             //{
@@ -48,6 +50,7 @@ int main()
         std::chrono::duration<double, std::milli> duration = end - start;
         std::cout << "Time taken for " << testCount << " nearest edge searches: " << duration.count() << " ms\n";
         std::cout << "Points per second: " << (testCount / (duration.count() / 1000.0)) << " points/s\n";
+        std::cout << "Quadtree nodes visited per search: " << static_cast<double>(visitedNodes) / testCount << "\n";
 
         std::cout << "Graph has " << graph.getEdges().size() << " edges.\n";
         std::cout << "Quadtree Box: " << quadtree.getBoundary().getTopLeft() << " to " << quadtree.getBoundary().getBottomRight() << std::endl;
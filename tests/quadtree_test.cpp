@@ -3,6 +3,7 @@
 #include <iostream>
 #include <cassert>
 #include <cstdlib>
+#include <set>
 
 #include "router.hpp"
 #include "library.hpp"
@@ -39,17 +40,29 @@ int main()
 
         std::cout << quadtree << "\n";
 
-        // Check every edge bounding box
+        // Segments sit in the leaves whose cell their bounding box overlaps, and every segment within the boundary is in at least one of them
+        size_t segmentCount = 0;
+        for(uint32_t edgeIndex = 0; edgeIndex < graph.getEdgeCount(); edgeIndex++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(edgeIndex);
+            for(uint8_t subwayId = 0; subwayId + 1 < edge->getPath().size(); subwayId++)
+            {
+                segmentCount += boundary.overlaps(edge->getBoundingBox(subwayId));
+            }
+        }
+        std::set<std::pair<Edge *, uint8_t>> storedSegments;
         for(Quadtree *subtree : quadtree.getAllSubtrees())
         {
+            assert(subtree->getEdgeSubwayIDs().empty() || subtree->getAllSubtrees().size() == 1);
             for(const auto &[edge, subwayId] : subtree->getEdgeSubwayIDs())
             {
                 if(edge == nullptr) continue;
 
-                const Box &box = edge->getBoundingBox(subwayId);
-                assert(subtree->getBoundary().contains(box));
+                assert(subtree->getBoundary().overlaps(edge->getBoundingBox(subwayId)));
+                storedSegments.emplace(edge, subwayId);
             }
         }
+        assert(storedSegments.size() == segmentCount);
 
         Coordinates testPoint(49.053357, 8.384253);
 
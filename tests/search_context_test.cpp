@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#include "router.hpp"
+#include "routes.hpp"
+#include "searchcontext.hpp"
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        Routes routes(router);
+
+        const Graph &graph = router.getGraph();
+
+        std::vector<std::pair<uint64_t, uint64_t>> queries;
+        for(int i = 0; i < 200; i++)
+        {
+            uint64_t startId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            uint64_t goalId = graph.getNodeByIndex(rand() % graph.getNodeCount())->getId();
+            queries.emplace_back(startId, goalId);
+        }
+
+        // Reference lengths with the Router's own search state
+        std::vector<double> expected;
+        for(const auto &[startId, goalId] : queries)
+        {
+            expected.push_back(routes.getLength(router.aStarEdges(startId, goalId)));
+        }
+
+        // Same queries from several threads, each with its own context
+        const unsigned threadCount = 4;
+        std::vector<std::vector<double>> results(threadCount, std::vector<double>(queries.size()));
+        std::vector<std::thread> threads;
+
+        for(unsigned t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                SearchContext context;
+                for(size_t i = 0; i < queries.size(); i++)
+                {
+                    results[t][i] = routes.getLength(router.aStarEdges(context, queries[i].first, queries[i].second));
+                }
+            });
+        }
+
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for(unsigned t = 0; t < threadCount; t++)
+        {
+            for(size_t i = 0; i < queries.size(); i++)
+            {
+                assert(std::abs(results[t][i] - expected[i]) < 1e-6);
+            }
+        }
+
+        std::cout << "Routed " << queries.size() << " queries on " << threadCount << " threads.\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
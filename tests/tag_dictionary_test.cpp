@@ -0,0 +1,89 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "parameters.hpp"
+#include "router.hpp"
+#include "tagdictionary.hpp"
+#include "weights.hpp"
+
+int main()
+{
+    try
+    {
+        TagDictionary &dictionary = TagDictionary::getInstance();
+
+        // Strings and sets get stable IDs
+        const uint32_t highway = dictionary.intern("highway");
+        assert(dictionary.intern(std::string("high") + "way") == highway);
+        assert(dictionary.getString(highway) == "highway");
+        assert(dictionary.find("no such string in the dictionary") == TagDictionary::INVALID_ID);
+
+        // Parameters keep their map semantics
+        Parameters parameters;
+        assert(parameters.getParameters().empty());
+        assert(parameters.getParameter("highway").empty());
+        parameters.setParameter("surface", "asphalt");
+        parameters.setParameter("highway", "unknown");
+        parameters.setParameter("highway", "primary");
+        assert(parameters.getParameters().size() == 2);
+        assert(parameters.getParameter("highway") == "primary");
+        assert(parameters.getParameter("surface") == "asphalt");
+
+        Parameters sameParameters({{dictionary.intern("highway"), dictionary.intern("secondary")},
+                                   {dictionary.intern("surface"), dictionary.intern("asphalt")},
+                                   {dictionary.intern("highway"), dictionary.intern("primary")}});
+        assert(sameParameters == parameters);
+        assert(sameParameters.getParameters() == parameters.getParameters());
+
+        size_t count = 0;
+        for(const auto &[key, value] : parameters.getParameters())
+        {
+            assert((key == "highway" && value == "primary") || (key == "surface" && value == "asphalt"));
+            count++;
+        }
+        assert(count == 2);
+
+        // Concurrent interning agrees on the IDs
+        std::vector<std::thread> threads;
+        std::vector<uint32_t> ids(8);
+        for(size_t thread = 0; thread < ids.size(); thread++)
+        {
+            threads.emplace_back([&, thread]()
+            {
+                for(int index = 0; index < 1000; index++) dictionary.intern("value" + std::to_string(index));
+                ids[thread] = dictionary.intern("value500");
+            });
+        }
+        for(auto &thread : threads) thread.join();
+        for(uint32_t id : ids) assert(id == ids[0]);
+
+        // The test map needs only a few tag sets, and weights by ID match the string lookup
+        Router router(std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm");
+        const Graph &graph = router.getGraph();
+        std::cout << graph.getEdgeCount() << " edges share " << dictionary.getTagSetCount() << " tag sets\n";
+        assert(dictionary.getTagSetCount() < graph.getEdgeCount());
+
+        Weights weights("weightsnew.csv");
+        weights.setWeight("highway", "residential", 0.25);
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            const Parameters &edgeParameters = graph.getEdgeByIndex(index)->getParameters();
+            double expected = 0.0;
+            for(const auto &[key, value] : edgeParameters.getParameters())
+            {
+                expected += weights.getWeight(std::string(key), std::string(value));
+            }
+            assert(std::abs(weights.getWeight(edgeParameters) - expected) < 1e-12);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cassert>
+
+#include "graph.hpp"
+#include "library.hpp"
+#include "osmnode.hpp"
+#include "osmway.hpp"
+
+int main()
+{
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+
+        auto begin = std::chrono::steady_clock::now();
+        Graph graph;
+        ankerl::unordered_dense::map<uint64_t, std::shared_ptr<OsmNode>> nodes;
+        ankerl::unordered_dense::map<uint64_t, std::unique_ptr<OsmWay>> ways;
+        HelperFunctions::readOSMFile(osmPath, nodes, ways);
+        const Box boundary = HelperFunctions::createGraph(graph, nodes, ways);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "Node maps: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+        begin = std::chrono::steady_clock::now();
+        Graph twoPassGraph;
+        const Box twoPassBoundary = HelperFunctions::readOSMGraph(osmPath, twoPassGraph);
+        end = std::chrono::steady_clock::now();
+        std::cout << "Two passes: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+
+        // Identical graph, including the dense indices
+        assert(graph.getNodeCount() == twoPassGraph.getNodeCount());
+        assert(graph.getEdgeCount() == twoPassGraph.getEdgeCount());
+        for(uint32_t index = 0; index < graph.getNodeCount(); index++)
+        {
+            const Node *node = graph.getNodeByIndex(index);
+            const Node *twoPassNode = twoPassGraph.getNodeByIndex(index);
+            assert(node->getId() == twoPassNode->getId());
+            assert(node->getCoordinates().getLatitude() == twoPassNode->getCoordinates().getLatitude());
+            assert(node->getCoordinates().getLongitude() == twoPassNode->getCoordinates().getLongitude());
+        }
+        for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+        {
+            const Edge *edge = graph.getEdgeByIndex(index);
+            const Edge *twoPassEdge = twoPassGraph.getEdgeByIndex(index);
+            assert(edge->getId() == twoPassEdge->getId());
+            assert(edge->from()->getIndex() == twoPassEdge->from()->getIndex());
+            assert(edge->to()->getIndex() == twoPassEdge->to()->getIndex());
+            assert(edge->getPath().size() == twoPassEdge->getPath().size());
+            assert(edge->getWeight() == twoPassEdge->getWeight());
+            assert(edge->getParameters().getParameters() == twoPassEdge->getParameters().getParameters());
+        }
+
+        assert(boundary.getMinLatitudeLongitude().getLatitude() == twoPassBoundary.getMinLatitudeLongitude().getLatitude());
+        assert(boundary.getMinLatitudeLongitude().getLongitude() == twoPassBoundary.getMinLatitudeLongitude().getLongitude());
+        assert(boundary.getMaxLatitudeLongitude().getLatitude() == twoPassBoundary.getMaxLatitudeLongitude().getLatitude());
+        assert(boundary.getMaxLatitudeLongitude().getLongitude() == twoPassBoundary.getMaxLatitudeLongitude().getLongitude());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "router.hpp"
+#include "library.hpp"
+#include "packedrtree.hpp"
+
+Coordinates randomCoordinateGenerator(const Box &box)
+{
+    double lat = box.getMinLatitudeLongitude().getLatitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLatitude() - box.getMinLatitudeLongitude().getLatitude());
+    double lon = box.getMinLatitudeLongitude().getLongitude() + static_cast<double>(rand()) / RAND_MAX * (box.getMaxLatitudeLongitude().getLongitude() - box.getMinLatitudeLongitude().getLongitude());
+    return Coordinates(lat, lon);
+}
+
+int main()
+{
+    srand(0);
+    try
+    {
+        const std::string osmPath = std::string(PROJECT_SOURCE_DIR) + "/testdata/neureut.osm";
+        Router router(osmPath);
+        const Graph &graph = router.getGraph();
+        const PackedRTree &rtree = router.getRTree();
+
+        for(int i = 0; i < 200; i++)
+        {
+            const Coordinates point = randomCoordinateGenerator(rtree.getBoundary());
+            for(double radius : {0.0, 20.0, 150.0})
+            {
+                // Every segment within the radius, found by brute force
+                std::vector<double> distances;
+                for(uint32_t index = 0; index < graph.getEdgeCount(); index++)
+                {
+                    const auto path = graph.getEdgeByIndex(index)->getPath();
+                    for(size_t subwayId = 0; subwayId + 1 < path.size(); subwayId++)
+                    {
+                        const double distance = HelperFunctions::distancePointToSegment(point, path[subwayId], path[subwayId + 1]);
+                        if(distance <= radius) distances.push_back(distance);
+                    }
+                }
+                std::sort(distances.begin(), distances.end());
+
+                auto closestEdges = rtree.withinRadius(point, radius);
+                assert(closestEdges.size() == distances.size());
+                for(size_t result = 0; result < closestEdges.size(); result++)
+                {
+                    assert(closestEdges[result].distance == distances[result]);
+                }
+
+                // One segment per edge, the closest one, still in order of distance
+                auto closestPerEdge = rtree.withinRadius(point, radius, false);
+                assert(closestPerEdge.size() <= closestEdges.size());
+                for(size_t a = 0; a < closestPerEdge.size(); a++)
+                {
+                    assert(a == 0 || closestPerEdge[a - 1].distance <= closestPerEdge[a].distance);
+                    for(size_t b = a + 1; b < closestPerEdge.size(); b++)
+                    {
+                        assert(closestPerEdge[a].edge != closestPerEdge[b].edge);
+                    }
+                }
+
+                // The nearest segments agree with the k nearest search as far as they reach into the radius
+                auto nearest = rtree.getClosestEdges(point, 3);
+                for(size_t result = 0; result < std::min<size_t>(3, closestEdges.size()); result++)
+                {
+                    assert(nearest[result].distance == closestEdges[result].distance);
+                }
+            }
+        }
+
+        // A segment's own vertex lies at distance 0
+        const Edge *edge = graph.getEdgeByIndex(0);
+        auto onRoad = rtree.withinRadius(edge->getPath().front(), 0.0);
+        assert(!onRoad.empty() && onRoad[0].distance == 0.0);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fehler im Test: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}